@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QPointer>
 #include <QSystemTrayIcon>
@@ -7,13 +8,26 @@
 #include <QPoint>
 #include <QRect>
 #include <QVariant>
+#include <QVector>
+
+#include <atomic>
+
+#include "ConfigStore.h"
+#include "Histogram.h"
+#include "TrayIconRenderer.h"
 
 class QMenu;
 class QAction;
 class QQuickView;
 
 class AudioBackend;
-class ConfigStore;
+class DiagnosticsWindow;
+class HiddenDeviceListModel;
+class HiddenProcessListModel;
+class HiddenPerDeviceListModel;
+struct HiddenDeviceEntry;
+struct HiddenProcessEntry;
+struct HiddenDeviceProcessesEntry;
 
 class AppController final : public QObject
 {
@@ -22,6 +36,14 @@ class AppController final : public QObject
     Q_PROPERTY(bool showSystemSessions READ showSystemSessions WRITE setShowSystemSessions NOTIFY showSystemSessionsChanged)
     Q_PROPERTY(bool showProcessStatusOnHover READ showProcessStatusOnHover WRITE setShowProcessStatusOnHover NOTIFY showProcessStatusOnHoverChanged)
     Q_PROPERTY(bool scrollWheelVolumeOnHover READ scrollWheelVolumeOnHover WRITE setScrollWheelVolumeOnHover NOTIFY scrollWheelVolumeOnHoverChanged)
+    // "buckets" | "levels" | "percent"
+    Q_PROPERTY(QString trayIconStyle READ trayIconStyle WRITE setTrayIconStyle NOTIFY trayIconStyleChanged)
+    Q_PROPERTY(bool rememberAppVolumes READ rememberAppVolumes WRITE setRememberAppVolumes NOTIFY rememberAppVolumesChanged)
+    Q_PROPERTY(bool rememberAppVolumesPerDevice READ rememberAppVolumesPerDevice WRITE setRememberAppVolumesPerDevice NOTIFY rememberAppVolumesChanged)
+    // Session row delegate bookkeeping (virtualized lists; exposed for testing/diagnostics).
+    Q_PROPERTY(int sessionDelegatesCreated READ sessionDelegatesCreated NOTIFY sessionDelegateStatsChanged)
+    Q_PROPERTY(int sessionDelegatesAlive READ sessionDelegatesAlive NOTIFY sessionDelegateStatsChanged)
+    Q_PROPERTY(int sessionDelegatesReused READ sessionDelegatesReused NOTIFY sessionDelegateStatsChanged)
 public:
     explicit AppController(QObject *parent = nullptr);
     ~AppController() override;
@@ -40,25 +62,56 @@ public:
     bool scrollWheelVolumeOnHover() const { return m_scrollWheelVolumeOnHover; }
     void setScrollWheelVolumeOnHover(bool v);
 
+    QString trayIconStyle() const { return TrayIconRenderer::styleToString(m_trayIcons.style()); }
+    void setTrayIconStyle(const QString &style);
+
+    bool rememberAppVolumes() const;
+    void setRememberAppVolumes(bool v);
+    bool rememberAppVolumesPerDevice() const;
+    void setRememberAppVolumesPerDevice(bool v);
+
+    int sessionDelegatesCreated() const { return m_sessionDelegatesCreated; }
+    int sessionDelegatesAlive() const { return m_sessionDelegatesAlive; }
+    int sessionDelegatesReused() const { return m_sessionDelegatesReused; }
+
 public slots:
     Q_INVOKABLE void toggleFlyout();
     Q_INVOKABLE void showFlyout();
     Q_INVOKABLE void hideFlyout();
     Q_INVOKABLE void showHiddenItemsWindow();
     Q_INVOKABLE void hideHiddenItemsWindow();
+    Q_INVOKABLE void showDiagnosticsWindow();
     // Called by QML when content height changes (e.g. sessions hidden/unhidden).
     Q_INVOKABLE void requestRelayout();
     Q_INVOKABLE void requestHiddenItemsRelayout();
     Q_INVOKABLE void setDeviceHidden(const QString &deviceId, bool hidden);
     Q_INVOKABLE void setProcessHiddenGlobal(const QString &exePath, bool hidden);
     Q_INVOKABLE void setProcessHiddenForDevice(const QString &deviceId, const QString &exePath, bool hidden);
+    Q_INVOKABLE void unhideAll();
     Q_INVOKABLE QPoint cursorPos() const;
     Q_INVOKABLE QRect cursorScreenAvailableGeometry() const;
-    Q_INVOKABLE QVariantList hiddenDevicesSnapshot() const;
-    Q_INVOKABLE QVariantList hiddenProcessesGlobalSnapshot() const;
-    Q_INVOKABLE QVariantList hiddenProcessesPerDeviceSnapshot() const;
     Q_INVOKABLE void popupOpened();
     Q_INVOKABLE void popupClosed();
+    Q_INVOKABLE void noteSessionDelegateCreated();
+    Q_INVOKABLE void noteSessionDelegateDestroyed();
+    Q_INVOKABLE void noteSessionDelegateReused();
+    // Tray click -> first presented flyout frame, one sample per open.
+    Q_INVOKABLE QVariantMap flyoutOpenLatency() const { return m_flyoutOpenLatency.toVariantMap(); }
+    // IconCache counters + icon texture/atlas usage for the sessions currently shown.
+    Q_INVOKABLE QVariantMap iconStats() const;
+    // Warm-start timings plus app start -> first flyout frame rendered with device rows.
+    Q_INVOKABLE QVariantMap startupStats() const;
+    // External volume/mute change -> models updated / frame presented, and slider input -> COM
+    // write, each with p50/p99.
+    Q_INVOKABLE QVariantMap changeLatency() const;
+    // Volume scenes (stored in ConfigStore, also offered in the tray menu).
+    Q_INVOKABLE QStringList sceneNames() const;
+    Q_INVOKABLE void saveScene(const QString &name);
+    Q_INVOKABLE void applyScene(const QString &name);
+    Q_INVOKABLE void removeScene(const QString &name);
+    // Apply latency; measureSceneApply() runs synthetic no-op scenes (50 targets by default).
+    Q_INVOKABLE QVariantMap sceneStats() const;
+    Q_INVOKABLE void measureSceneApply(int targetCount = 50, int runs = 20);
     void showAboutDialog();
 
 signals:
@@ -66,24 +119,47 @@ signals:
     void showSystemSessionsChanged();
     void showProcessStatusOnHoverChanged();
     void scrollWheelVolumeOnHoverChanged();
+    void trayIconStyleChanged();
+    void rememberAppVolumesChanged();
     void closeAllPopupsRequested();
     void hiddenItemsChanged();
+    void sessionDelegateStatsChanged();
 
 private slots:
     void rebuildHiddenMenus();
+    void refreshHiddenItemsModels();
+    void onConfigChanged(const ConfigStore::ChangeSet &changes);
 
 private:
     void buildTray();
     void buildFlyout();
     void buildHiddenItemsWindow();
+    // Folds the per-component stats maps into the Metrics registry snapshot.
+    void registerMetricSources();
     void positionFlyout();
     void positionHiddenItemsWindow(bool recomputeAnchor);
     void adjustFlyoutHeightToContent();
     void adjustHiddenItemsHeightToContent();
+    void prewarmFlyout();
+    void finishPrewarm();
+    void scheduleHiddenFlyoutLayout();
+    void layoutHiddenFlyout();
+    int placeholderIconRows() const;
+    void noteFirstPaintIconMisses();
     void setStartWithWindows(bool v);
     void applyStartWithWindows(bool v);
     void applyWindowEffectsIfPossible(QQuickView *view);
     void updateTrayIcon();
+    void rebuildTrayIcons();
+    void rebuildScenesMenu();
+    void promptSaveScene();
+    void applyTrayIcon(int level, bool muted);
+    void scheduleHiddenItemsRefresh();
+    void syncHiddenItemsModels();
+
+    QVector<HiddenDeviceEntry> hiddenDeviceEntries() const;
+    QVector<HiddenProcessEntry> hiddenProcessGlobalEntries() const;
+    QVector<HiddenDeviceProcessesEntry> hiddenProcessPerDeviceEntries() const;
 
     bool eventFilter(QObject *watched, QEvent *event) override;
 
@@ -91,6 +167,7 @@ private:
     QPointer<QMenu> m_menu;
     QPointer<QMenu> m_hiddenDevicesMenu;
     QPointer<QMenu> m_hiddenProcessesMenu;
+    QPointer<QMenu> m_scenesMenu;
 
     QAction *m_actionOpen = nullptr;
     QAction *m_actionQuit = nullptr;
@@ -100,6 +177,7 @@ private:
 
     QPointer<QQuickView> m_view;
     QPointer<QQuickView> m_hiddenView;
+    QPointer<DiagnosticsWindow> m_diagnostics;
 
     QPoint m_hiddenAnchorPos;
     QRect m_hiddenAnchorWork;
@@ -108,6 +186,13 @@ private:
     QPointer<AudioBackend> m_audio;
     QPointer<ConfigStore> m_config;
 
+    // Backing models for the hidden-items window; diffed in place on every hiddenItemsChanged.
+    HiddenDeviceListModel *m_hiddenDevicesModel = nullptr;
+    HiddenProcessListModel *m_hiddenProcessesGlobalModel = nullptr;
+    HiddenPerDeviceListModel *m_hiddenProcessesPerDeviceModel = nullptr;
+    QTimer m_hiddenItemsRefresh;
+    bool m_hiddenItemsDirty = true;
+
     bool m_allDevices = false;
     bool m_showSystemSessions = false;
     bool m_showProcessStatusOnHover = false;
@@ -117,8 +202,14 @@ private:
     QTimer m_trayIconCoalesce;
     int m_pendingTrayVolPct = -1;
     bool m_pendingTrayMuted = false;
-    int m_lastTrayVolPct = -1;
+    int m_lastTrayVolPct = 100;
+    int m_lastTrayLevel = -1;
     bool m_lastTrayMuted = false;
+    // Every tray state pre-rasterized per screen DPI; setIcon only runs when the pixels differ.
+    TrayIconRenderer m_trayIcons;
+    size_t m_appliedTrayPixelKey = 0;
+    bool m_trayIconApplied = false;
+    quint64 m_trayIconSets = 0;
 
     // When the flyout closes due to WindowDeactivate (e.g. clicking the tray icon),
     // the tray "activated" signal may arrive right after and would re-open it.
@@ -129,12 +220,40 @@ private:
     // Coalesce repeated relayout requests while QML is settling.
     QTimer m_relayoutCoalesce;
 
+    // Pre-warm: the flyout keeps its graphics/scene graph across hide(), and model changes while
+    // it is hidden lay it out ahead of time so opening only has to present a frame.
+    QTimer m_hiddenLayoutCoalesce;
+    bool m_flyoutLayoutDirty = true;
+    std::atomic<bool> m_prewarming{false};
+
+    QElapsedTimer m_flyoutOpenClock;
+    bool m_flyoutClickPending = false;
+    std::atomic<bool> m_awaitingFlyoutFrame{false};
+    Histogram m_flyoutOpenLatency;
+    // Render thread only: change stamps picked up at the last sync, timed at its frameSwapped.
+    QVector<qint64> m_frameChangeStamps;
+
+    // Time-to-first-useful-paint: the first visible frame rendered with at least one device row,
+    // measured from AppController construction. The invisible prewarm frame is reported apart.
+    QElapsedTimer m_startupClock;
+    std::atomic<bool> m_hasDeviceRows{false};
+    std::atomic<qint64> m_firstUsefulPaintNs{-1};
+    std::atomic<qint64> m_prewarmPaintNs{-1};
+    bool m_deviceRowsFromWarmStart = false;
+    // Session rows still showing the icon placeholder on the first frame of an open.
+    int m_lastFirstPaintIconMisses = 0;
+    quint64 m_totalFirstPaintIconMisses = 0;
+
     // Avoid rebuilding the tray menus while the tray context menu is open (causes flicker/close/crash).
     bool m_deferHiddenMenuRebuild = false;
 
     // QML menus/popups (QtQuick Controls) can be separate native windows and can trigger WindowDeactivate
     // on the flyout. While a popup is open we suppress auto-close, and close once popups are gone.
     int m_popupDepth = 0;
+
+    int m_sessionDelegatesCreated = 0;
+    int m_sessionDelegatesAlive = 0;
+    int m_sessionDelegatesReused = 0;
 };
 
 
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+
+// Remembered per-application volume/mute, restored when the app opens a new audio session.
+struct AppVolume
+{
+    double volume = 1.0; // 0..1
+    bool muted = false;
+
+    bool operator==(const AppVolume &o) const { return qFuzzyCompare(volume + 1.0, o.volume + 1.0) && muted == o.muted; }
+    bool operator!=(const AppVolume &o) const { return !(*this == o); }
+};
+
+// Keyed by appVolumeKey(); device-specific entries take precedence over per-exe ones.
+using AppVolumeTable = QHash<QString, AppVolume>;
+
+// Paths are case-insensitive on Windows; deviceId empty for the per-exe (any device) entry.
+inline QString appVolumeKey(const QString &deviceId, const QString &exePath)
+{
+    const QString exe = exePath.toCaseFolded();
+    return deviceId.isEmpty() ? exe : deviceId + QLatin1Char('|') + exe;
+}
@@ -1,24 +1,36 @@
 #pragma once
 
 #include <QObject>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QPointer>
 #include <QThread>
+#include <QTimer>
+#include <QVariantMap>
 #include <QVector>
 
-class ConfigStore;
+#include <utility>
+
+#include "ConfigStore.h"
+#include "HiddenRuleMatcher.h"
+#include "Histogram.h"
+
 class DeviceListModel;
 class AudioDevice;
-class AudioSession;
 class IconCache;
 class UpdateCoalescer;
+class VolumeCommitScheduler;
 class AudioWorker;
 struct DeviceState;
 struct SessionPeak;
+struct VolumeTarget;
 
 class AudioBackend final : public QObject
 {
     Q_OBJECT
+    // True while the models show the warm-start cache from the previous run, until the worker's
+    // first real snapshot has been reconciled into them.
+    Q_PROPERTY(bool stale READ isStale NOTIFY staleChanged)
 public:
     struct DeviceSnapshot {
         QString id;
@@ -39,6 +51,19 @@ public:
     void start();
     void refresh();
 
+    bool isStale() const { return m_stale; }
+    // { warmStartDevices, warmStartSessions, warmStartAppliedMs, firstSnapshotMs, stale }; times are
+    // from backend construction.
+    QVariantMap startupStats() const;
+    // HiddenRuleMatcher::stats() of the compiled rules.
+    QVariantMap hiddenRuleStats() const;
+    // Change stamps (Metrics::nowNs()) of external volume/mute changes applied to the models since
+    // the last call. Taken by the flyout while the scene graph syncs, i.e. with the GUI thread
+    // blocked, to time change -> displayed frame.
+    QVector<qint64> takeAppliedChangeStamps() { return std::exchange(m_appliedChangeStamps, {}); }
+    // Last few AudioWorker::error messages, oldest first, each prefixed with its local time.
+    QStringList recentErrors() const { return m_recentErrors; }
+
     DeviceListModel *deviceModel() const { return m_deviceModel; }
     IconCache *iconCache() const { return m_iconCache; }
 
@@ -54,12 +79,24 @@ public:
     QVector<ProcessSnapshot> knownProcessesForDeviceSnapshot(const QString &deviceId) const;
     QVector<ProcessSnapshot> knownProcessesForDeviceSnapshotAll(const QString &deviceId) const;
 
-    // Called by QML via AudioDevice/AudioSession objects.
+    // Called by QML via AudioDevice objects and SessionListModel rows. Volume writes are debounced by the
+    // shared VolumeCommitScheduler; mute is applied immediately.
     void setDeviceVolume(const QString &deviceId, double volume01);
     void setDeviceMuted(const QString &deviceId, bool muted);
     void setSessionVolume(const QString &deviceId, quint32 pid, const QString &exePath, double volume01);
     void setSessionMuted(const QString &deviceId, quint32 pid, const QString &exePath, bool muted);
 
+    // Every device and session level/mute in the last snapshot (hidden ones included).
+    VolumeScene captureScene(const QString &name) const;
+    // Updates the models right away and hands all targets to the worker as one batch.
+    void applyScene(const VolumeScene &scene);
+    // { applies, lastTargets, lastWritten, applyLatency, writeLatency }: applyLatency is request ->
+    // last COM write (queue hop included), writeLatency the worker's write pass alone.
+    QVariantMap sceneStats() const;
+    // Applies `runs` scenes of exactly targetCount targets; the worker writes back each object's
+    // current level (so nothing audible changes). Results land in sceneStats().
+    void measureSceneApply(int targetCount = 50, int runs = 20);
+
 public slots:
     Q_INVOKABLE void moveDeviceBefore(const QString &movingDeviceId, const QString &beforeDeviceId);
     Q_INVOKABLE void moveDeviceToIndex(const QString &movingDeviceId, int toIndex);
@@ -68,28 +105,72 @@ signals:
     void devicesChanged();
     void knownProcessesChanged();
     void defaultDeviceChanged();
+    void staleChanged();
 
 private:
+    friend class AudioBackendProbe; // tests/
+
+    // Without an icon cache rows use the exe path as icon key (scratch instances must not share
+    // the on-disk icon cache with the real one).
+    AudioBackend(QObject *parent, bool withIconCache);
+
     void applySnapshot(const QVector<DeviceState> &devices);
+    void applyWarmStart();
+    void onLiveSnapshot(const QVector<DeviceState> &devices);
+    // Re-filters one device's sessions against the hidden rules; true if rows changed.
+    bool syncDeviceSessions(AudioDevice *dev, const DeviceState &ds, QSet<QString> *shownExePaths);
+    // Reorders the model to the configured device order (restricted to `keep`); true if rows moved.
+    bool applyConfiguredDeviceOrder(const QSet<QString> &keep);
+    void onConfigChanged(const ConfigStore::ChangeSet &changes);
+    void pushAppVolumeTable();
     void applyPeaks(const QVector<SessionPeak> &peaks);
+    void commitVolumes(const QVector<VolumeTarget> &targets);
+    void onSceneApplied(int targets, int written, qint64 queuedNs, qint64 writeNs, bool measurement);
+    void noteChangesApplied(const QVector<qint64> &changeStampsNs);
     void rebuildMenusIfChanged(bool devicesChanged, bool processesChanged, bool defaultDeviceChanged);
 
     QPointer<ConfigStore> m_config;
+    // Compiled from the config's hidden-process rules; recompiled when they change.
+    HiddenRuleMatcher m_hiddenRules;
     bool m_allDevices = false;
     bool m_showSystemSessions = false;
 
     DeviceListModel *m_deviceModel = nullptr;
     IconCache *m_iconCache = nullptr;
     UpdateCoalescer *m_coalescer = nullptr;
+    VolumeCommitScheduler *m_volumeCommits = nullptr;
 
     QThread m_workerThread;
     AudioWorker *m_worker = nullptr;
+    // Remembered levels reach the worker at most this often (they only matter for new sessions).
+    static constexpr int kAppVolumePushDelayMs = 500;
+    QTimer m_appVolumePushDebounce;
 
     QHash<QString, AudioDevice *> m_deviceById;
-    // deviceId -> (pid|exePath) -> session
-    QHash<QString, QHash<QString, AudioSession *>> m_sessionByKeyByDevice;
 
     QVector<DeviceState> m_lastSnapshot;
+    // Tracer flow of the live snapshot being applied (0 otherwise).
+    quint64 m_traceFlow = 0;
+    static constexpr int kMaxAppliedChangeStamps = 256;
+    QVector<qint64> m_appliedChangeStamps;
+
+    // Warm start: cached state shown until the first live snapshot arrives.
+    bool m_stale = false;
+    QElapsedTimer m_startupClock;
+    int m_warmStartDevices = 0;
+    int m_warmStartSessions = 0;
+    qint64 m_warmStartAppliedMs = -1;
+    qint64 m_firstSnapshotMs = -1;
+
+    static constexpr int kRecentErrorCount = 20;
+    QStringList m_recentErrors;
+
+    Histogram m_sceneApplyLatency;
+    Histogram m_sceneWriteLatency;
+    int m_lastSceneTargets = 0;
+    int m_lastSceneWritten = 0;
+    QVector<VolumeTarget> m_measureTargets;
+    int m_measureRunsLeft = 0;
 
     bool m_hasDefaultDevice = false;
     QString m_defaultDeviceId;
@@ -2,7 +2,6 @@
 
 #include <QAbstractItemModel>
 #include <QObject>
-#include <QTimer>
 #include <QString>
 
 #include "SessionListModel.h"
@@ -48,8 +47,6 @@ signals:
     void changed();
 
 private:
-    void flushPendingVolume();
-
     AudioBackend *m_backend = nullptr;
     QString m_id;
     QString m_name;
@@ -58,9 +55,6 @@ private:
     bool m_muted = false;
     double m_peak = 0.0;
     SessionListModel *m_sessions = nullptr;
-
-    QTimer m_volumeCommitTimer;
-    double m_pendingVolume = -1.0;
 };
 
 
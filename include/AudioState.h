@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+// What AudioWorker reports: endpoints, their sessions and the sessions' meter peaks.
+
+struct SessionState
+{
+    QString deviceId;
+    quint32 pid = 0;
+    QString exePath;
+    QString displayName;
+    QString iconKey; // currently exePath; backend may override
+    double volume = 1.0; // 0..1
+    bool muted = false;
+    bool active = false;
+    qint64 lastActiveMs = 0; // epoch ms
+};
+
+struct DeviceState
+{
+    QString id;
+    QString name;
+    bool isDefault = false;
+    double volume = 1.0; // 0..1
+    bool muted = false;
+    QVector<SessionState> sessions;
+};
+
+struct SessionPeak
+{
+    QString deviceId;
+    quint32 pid = 0;
+    QString exePath;
+    double peak = 0.0; // 0..1
+};
+
+Q_DECLARE_METATYPE(SessionState)
+Q_DECLARE_METATYPE(DeviceState)
+Q_DECLARE_METATYPE(QVector<DeviceState>)
+Q_DECLARE_METATYPE(SessionPeak)
+Q_DECLARE_METATYPE(QVector<SessionPeak>)
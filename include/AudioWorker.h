@@ -1,45 +1,17 @@
 #pragma once
 
+#include <QMutex>
 #include <QObject>
 #include <QTimer>
 #include <QVector>
 
-struct SessionState
-{
-    QString deviceId;
-    quint32 pid = 0;
-    QString exePath;
-    QString displayName;
-    QString iconKey; // currently exePath; backend may override
-    double volume = 1.0; // 0..1
-    bool muted = false;
-    bool active = false;
-    qint64 lastActiveMs = 0; // epoch ms
-};
-
-struct DeviceState
-{
-    QString id;
-    QString name;
-    bool isDefault = false;
-    double volume = 1.0; // 0..1
-    bool muted = false;
-    QVector<SessionState> sessions;
-};
+#include <atomic>
+#include <memory>
 
-struct SessionPeak
-{
-    QString deviceId;
-    quint32 pid = 0;
-    QString exePath;
-    double peak = 0.0; // 0..1
-};
-
-Q_DECLARE_METATYPE(SessionState)
-Q_DECLARE_METATYPE(DeviceState)
-Q_DECLARE_METATYPE(QVector<DeviceState>)
-Q_DECLARE_METATYPE(SessionPeak)
-Q_DECLARE_METATYPE(QVector<SessionPeak>)
+#include "AppVolumeMemory.h"
+#include "AudioState.h"
+#include "SessionHistory.h"
+#include "VolumeTarget.h"
 
 class AudioWorker final : public QObject
 {
@@ -48,29 +20,63 @@ public:
     explicit AudioWorker(QObject *parent = nullptr);
     ~AudioWorker() override;
 
+    // Thread-safe (may be called from the GUI thread before start()). Swaps in the table that
+    // OnSessionCreated consults; readers never block on a rebuild.
+    void setAppVolumeTable(const AppVolumeTable &table);
+    quint64 appVolumesApplied() const { return m_appVolumesApplied.load(std::memory_order_relaxed); }
+
 public slots:
     void start();
     void stop();
 
     void setShowSystemSessions(bool show);
 
-    void setDeviceVolume(const QString &deviceId, double volume01);
+    // Applies a drained batch from VolumeCommitScheduler in one pass.
+    void setVolumes(const QVector<VolumeTarget> &targets);
+    // Writes a whole scene in one pass and reports how long it took. requestedAtNs is
+    // Metrics::nowNs() on the caller's side, so the report covers the queue hop as well.
+    // measurement: ignore the targets' levels and write back what each endpoint/session has right
+    // now (read just before the write), so a timing run can never undo a user's change.
+    void applyScene(const QVector<VolumeTarget> &targets, qint64 requestedAtNs, bool measurement);
     void setDeviceMuted(const QString &deviceId, bool muted);
-    void setSessionVolume(const QString &deviceId, quint32 pid, const QString &exePath, double volume01);
     void setSessionMuted(const QString &deviceId, quint32 pid, const QString &exePath, bool muted);
 
 signals:
-    void snapshotReady(const QVector<DeviceState> &devices);
+    // traceFlow: Tracer flow id for this snapshot (0 while tracing is off). changeStampsNs:
+    // Metrics::nowNs() of each external volume/mute change this snapshot is the first to show.
+    void snapshotReady(const QVector<DeviceState> &devices, quint64 traceFlow, const QVector<qint64> &changeStampsNs);
     void peaksReady(const QVector<SessionPeak> &peaks);
+    // An executable shows up in a session (OnSessionCreated or a snapshot) that was not in the
+    // previous snapshot. Drives icon prefetch.
+    void executableSeen(const QString &exePath);
+    // queuedNs: request -> worker picked it up; writeNs: the COM write pass itself.
+    // measurement echoes the applyScene() argument.
+    void sceneApplied(int targets, int written, qint64 queuedNs, qint64 writeNs, bool measurement);
     void error(const QString &message);
 
 private:
-    void scheduleSnapshot();
+    // traceFlow: Tracer flow of the change that asked for it (0 = untraced); changeStampNs: when
+    // an external volume/mute change happened (0 = not one).
+    void scheduleSnapshot(quint64 traceFlow = 0, qint64 changeStampNs = 0);
+    void noteExecutableSeen(const QString &exePath);
     void emitSnapshotNow();
     void emitPeaksNow();
+    // Shared by setVolumes/applyScene; returns how many COM objects were written.
+    // rewriteCurrent: write each object's current level/mute instead of the target's.
+    int writeTargets(const QVector<VolumeTarget> &targets, bool rewriteCurrent = false);
+    // Any thread (COM notification threads included).
+    bool rememberedVolume(const QString &deviceId, const QString &exePath, AppVolume *out) const;
 
     bool m_showSystemSessions = false;
+    SessionHistory m_history; // last-active times and announced executables
+    QVector<quint64> m_pendingTraceFlows; // traced changes waiting for the next snapshot
+    static constexpr int kMaxPendingChangeStamps = 256;
+    QVector<qint64> m_pendingChangeStamps;
     std::atomic<bool> m_destroying{false};
+
+    mutable QMutex m_appVolumesLock;
+    std::shared_ptr<const AppVolumeTable> m_appVolumes;
+    std::atomic<quint64> m_appVolumesApplied{0};
     QTimer m_snapshotTimer;
     QTimer m_meterTimer;
 
@@ -1,9 +1,21 @@
 #pragma once
 
 #include <QObject>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QJsonObject>
 #include <QSet>
 #include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVariantMap>
+
+#include <atomic>
+
+#include "AppVolumeMemory.h"
+#include "VolumeScene.h"
+
+class QFileSystemWatcher;
 
 class ConfigStore final : public QObject
 {
@@ -12,32 +24,93 @@ public:
     enum class Mode { DefaultDeviceOnly, AllDevices };
     Q_ENUM(Mode)
 
+    // What a committed mutation (or batch of mutations) touched, so listeners can react to
+    // only the relevant part instead of re-deriving everything.
+    struct ChangeSet
+    {
+        enum Field : quint32 {
+            ModeField = 1u << 0,
+            ShowSystemSessionsField = 1u << 1,
+            ShowProcessStatusOnHoverField = 1u << 2,
+            ScrollWheelVolumeOnHoverField = 1u << 3,
+            StartWithWindowsField = 1u << 4,
+            TrayIconStyleField = 1u << 5,
+            HiddenDevicesField = 1u << 6,
+            HiddenProcessesGlobalField = 1u << 7,
+            HiddenProcessesPerDeviceField = 1u << 8,
+            DeviceOrderField = 1u << 9,
+            RememberAppVolumesField = 1u << 10,
+            AppVolumesField = 1u << 11,
+            ScenesField = 1u << 12,
+
+            HiddenRulesFields = HiddenDevicesField | HiddenProcessesGlobalField | HiddenProcessesPerDeviceField
+        };
+
+        quint32 fields = 0;
+        QSet<QString> deviceIds; // devices whose hidden flag or per-device rules changed
+        QSet<QString> exePaths;  // processes whose global or per-device hidden flag changed
+
+        bool isEmpty() const { return fields == 0; }
+        bool has(quint32 mask) const { return (fields & mask) != 0; }
+        void merge(const ChangeSet &other)
+        {
+            fields |= other.fields;
+            deviceIds.unite(other.deviceIds);
+            exePaths.unite(other.exePaths);
+        }
+    };
+
+    // Groups mutations into one notification: changed()/changesCommitted() fire once, with the
+    // merged change set, when the outermost batch ends. Nestable.
+    class Batch
+    {
+    public:
+        explicit Batch(ConfigStore *store);
+        ~Batch();
+        Batch(const Batch &) = delete;
+        Batch &operator=(const Batch &) = delete;
+
+    private:
+        ConfigStore *m_store;
+    };
+
     explicit ConfigStore(QObject *parent = nullptr);
+    ~ConfigStore() override;
 
+    // Reads config.json and starts watching it: external edits (e.g. rules pushed by a deployment
+    // script) are parsed off the GUI thread, diffed against what we last persisted, and applied as
+    // one batch of targeted changes.
     void load();
-    void save() const;
+    // Synchronous atomic write of the current state.
+    void save();
+    // Writes any pending debounced change and waits for the writer; called on quit and destruction.
+    void flush();
 
     QString configPath() const;
 
-    Mode mode() const { return m_mode; }
+    Mode mode() const { return m_d.mode; }
     void setMode(Mode m);
 
-    bool showSystemSessions() const { return m_showSystemSessions; }
+    bool showSystemSessions() const { return m_d.showSystemSessions; }
     void setShowSystemSessions(bool v);
 
-    bool showProcessStatusOnHover() const { return m_showProcessStatusOnHover; }
+    bool showProcessStatusOnHover() const { return m_d.showProcessStatusOnHover; }
     void setShowProcessStatusOnHover(bool v);
 
-    bool scrollWheelVolumeOnHover() const { return m_scrollWheelVolumeOnHover; }
+    bool scrollWheelVolumeOnHover() const { return m_d.scrollWheelVolumeOnHover; }
     void setScrollWheelVolumeOnHover(bool v);
 
-    bool startWithWindows() const { return m_startWithWindows; }
+    bool startWithWindows() const { return m_d.startWithWindows; }
     void setStartWithWindows(bool v);
 
+    // "buckets" | "levels" | "percent" (see TrayIconRenderer::Style).
+    QString trayIconStyle() const { return m_d.trayIconStyle; }
+    void setTrayIconStyle(const QString &style);
+
     bool isDeviceHidden(const QString &deviceId) const;
     void setDeviceHidden(const QString &deviceId, bool hidden);
     QStringList hiddenDevices() const;
-    QStringList deviceOrder() const { return m_deviceOrder; }
+    QStringList deviceOrder() const { return m_d.deviceOrder; }
     void setDeviceOrder(const QStringList &order);
 
     bool isProcessHiddenGlobal(const QString &exePath) const;
@@ -46,24 +119,99 @@ public:
     bool isProcessHiddenForDevice(const QString &deviceId, const QString &exePath) const;
     void setProcessHiddenForDevice(const QString &deviceId, const QString &exePath, bool hidden);
 
-    const QSet<QString> &hiddenProcessesGlobalSet() const { return m_hiddenProcessesGlobal; }
-    const QHash<QString, QSet<QString>> &hiddenProcessesPerDeviceMap() const { return m_hiddenProcessesPerDevice; }
+    const QSet<QString> &hiddenProcessesGlobalSet() const { return m_d.hiddenProcessesGlobal; }
+    const QHash<QString, QSet<QString>> &hiddenProcessesPerDeviceMap() const { return m_d.hiddenProcessesPerDevice; }
 
-signals:
-    void changed();
+    // Per-app volume memory: the last level/mute the user set for an exe (or exe on one device
+    // when perDevice is on), restored when that app opens a new session.
+    bool rememberAppVolumes() const { return m_d.rememberAppVolumes; }
+    void setRememberAppVolumes(bool v);
+    bool rememberAppVolumesPerDevice() const { return m_d.rememberAppVolumesPerDevice; }
+    void setRememberAppVolumesPerDevice(bool v);
+    const AppVolumeTable &appVolumes() const { return m_d.appVolumes; }
+    void rememberAppVolume(const QString &deviceId, const QString &exePath, double volume01, bool muted);
 
-private:
-    Mode m_mode = Mode::DefaultDeviceOnly;
-    bool m_showSystemSessions = false;
-    bool m_showProcessStatusOnHover = false;
-    bool m_scrollWheelVolumeOnHover = false;
-    bool m_startWithWindows = false;
+    // Named volume scenes, in creation order. Saving under an existing name replaces that scene.
+    const VolumeSceneList &scenes() const { return m_d.scenes; }
+    void saveScene(const VolumeScene &scene);
+    void removeScene(const QString &name);
 
-    QSet<QString> m_hiddenDevices;
-    QSet<QString> m_hiddenProcessesGlobal; // exePath
-    QHash<QString, QSet<QString>> m_hiddenProcessesPerDevice; // deviceId -> exePaths
+    void beginBatch();
+    void endBatch();
 
-    QStringList m_deviceOrder; // ordered list of deviceIds
-};
+    // Persistence counters: { savesRequested, savesWritten, savesCoalesced, writesSuperseded,
+    // saveFailures, notificationsBatched, externalReloads }. savesCoalesced counts changes folded
+    // into an already pending save; writesSuperseded counts queued writes skipped on the writer
+    // because a newer snapshot was behind them.
+    QVariantMap saveStats() const;
 
+signals:
+    void changed();
+    // Emitted right after changed() with what it covered.
+    void changesCommitted(const ConfigStore::ChangeSet &changes);
 
+private:
+    // Everything persisted in config.json. Kept as one value so a save can snapshot it
+    // (implicitly shared containers make the copy cheap) and serialize it off the GUI thread.
+    struct Data
+    {
+        Mode mode = Mode::DefaultDeviceOnly;
+        bool showSystemSessions = false;
+        bool showProcessStatusOnHover = false;
+        bool scrollWheelVolumeOnHover = false;
+        bool startWithWindows = false;
+        QString trayIconStyle = QStringLiteral("buckets");
+
+        QSet<QString> hiddenDevices;
+        QSet<QString> hiddenProcessesGlobal; // exePath
+        QHash<QString, QSet<QString>> hiddenProcessesPerDevice; // deviceId -> exePaths
+
+        QStringList deviceOrder; // ordered list of deviceIds
+
+        bool rememberAppVolumes = true;
+        bool rememberAppVolumesPerDevice = false;
+        AppVolumeTable appVolumes;
+
+        VolumeSceneList scenes;
+    };
+
+    void noteChange(const ChangeSet &changes);
+    void noteChange(ChangeSet::Field field) { noteChange(ChangeSet{field, {}, {}}); }
+    void scheduleSave();
+    void writeBehind();
+    void watchConfigFile();
+    void reloadInBackground();
+    void applyExternal(const Data &ext);
+    static bool parse(const QByteArray &bytes, Data *out);
+    static QJsonObject toJson(const Data &d);
+    static bool writeFile(const QString &path, const QByteArray &bytes);
+    static ChangeSet diff(const Data &a, const Data &b);
+
+    Data m_d;
+    // What config.json holds as far as we know (last load, reload or queued write); the base
+    // for diffing external edits.
+    Data m_persisted;
+
+    int m_batchDepth = 0;
+    ChangeSet m_batchChanges;
+    quint64 m_notificationsBatched = 0;
+
+    // Saves are debounced on the GUI thread and written by a single background thread
+    // (so writes stay ordered) via QSaveFile: temp file + rename, never a truncated config.json.
+    QTimer m_saveDebounce;
+    QElapsedTimer m_dirtySince;
+    bool m_dirty = false;
+    QThreadPool m_writer;
+    std::atomic<quint64> m_saveGeneration{0};
+    quint64 m_savesRequested = 0;
+    std::atomic<quint64> m_savesWritten{0};
+    std::atomic<quint64> m_savesCoalesced{0};
+    std::atomic<quint64> m_writesSuperseded{0};
+    std::atomic<quint64> m_saveFailures{0};
+
+    QFileSystemWatcher *m_watcher = nullptr;
+    QTimer m_reloadDebounce;
+    std::atomic<size_t> m_fileHash{0}; // qHash of the bytes last read or written
+    bool m_applyingExternal = false;
+    quint64 m_externalReloads = 0;
+};
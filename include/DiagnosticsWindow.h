@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QTimer>
+#include <QWidget>
+
+class QPlainTextEdit;
+class QPushButton;
+
+// Live view of Metrics::snapshot() (refreshed once a second while shown) with copy/export
+// to JSON, and start/stop for the Chrome trace recorder. Opened from the tray menu.
+class DiagnosticsWindow final : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit DiagnosticsWindow(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void refresh();
+    void exportJson();
+    void toggleTrace();
+    void syncTraceButton();
+
+    QPlainTextEdit *m_text = nullptr;
+    QPushButton *m_traceButton = nullptr;
+    QTimer m_refresh;
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+// Row-diffing list model: syncRows() turns a freshly computed row list into the minimal set of
+// remove/move/insert/dataChanged notifications, so QML delegates are only touched for rows
+// that actually changed.
+template <typename Row>
+class KeyedListModel : public QAbstractListModel
+{
+public:
+    explicit KeyedListModel(QObject *parent = nullptr)
+        : QAbstractListModel(parent)
+    {
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        if (parent.isValid())
+            return 0;
+        return m_rows.size();
+    }
+
+    const QVector<Row> &rows() const { return m_rows; }
+
+protected:
+    virtual QString rowKey(const Row &row) const = 0;
+    // Copies `next` into `row` and returns the roles whose value changed (empty if none).
+    virtual QVector<int> updateRow(Row &row, const Row &next) = 0;
+    // Hooks for rows that own extra state (e.g. nested models).
+    virtual void prepareRow(Row &) {}
+    virtual void releaseRow(Row &) {}
+
+    void syncRows(const QVector<Row> &next)
+    {
+        QSet<QString> nextKeys;
+        nextKeys.reserve(next.size());
+        for (const auto &r : next)
+            nextKeys.insert(rowKey(r));
+
+        for (int i = m_rows.size() - 1; i >= 0; --i) {
+            if (nextKeys.contains(rowKey(m_rows.at(i))))
+                continue;
+            beginRemoveRows(QModelIndex(), i, i);
+            Row removed = m_rows.takeAt(i);
+            endRemoveRows();
+            releaseRow(removed);
+        }
+
+        // Rows [0, i) already match next[0, i), so any existing match for next[i] is at >= i.
+        for (int i = 0; i < next.size(); ++i) {
+            const QString key = rowKey(next.at(i));
+            int cur = -1;
+            for (int j = i; j < m_rows.size(); ++j) {
+                if (rowKey(m_rows.at(j)) == key) {
+                    cur = j;
+                    break;
+                }
+            }
+
+            if (cur < 0) {
+                Row row = next.at(i);
+                prepareRow(row);
+                beginInsertRows(QModelIndex(), i, i);
+                m_rows.insert(i, row);
+                endInsertRows();
+                continue;
+            }
+
+            if (cur != i) {
+                beginMoveRows(QModelIndex(), cur, cur, QModelIndex(), i);
+                m_rows.move(cur, i);
+                endMoveRows();
+            }
+
+            const QVector<int> roles = updateRow(m_rows[i], next.at(i));
+            if (!roles.isEmpty()) {
+                const QModelIndex idx = index(i, 0);
+                emit dataChanged(idx, idx, roles);
+            }
+        }
+    }
+
+    QVector<Row> m_rows;
+};
+
+struct HiddenDeviceEntry
+{
+    QString deviceId;
+    QString name;
+    bool connected = true;
+    bool hidden = false;
+};
+
+struct HiddenProcessEntry
+{
+    QString exePath;
+    QString name;
+    bool hidden = false;
+};
+
+class HiddenProcessListModel;
+
+struct HiddenDeviceProcessesEntry
+{
+    QString deviceId;
+    QString name;
+    bool connected = true;
+    QVector<HiddenProcessEntry> processes;
+    HiddenProcessListModel *processesModel = nullptr; // owned by HiddenPerDeviceListModel
+};
+
+class HiddenDeviceListModel final : public KeyedListModel<HiddenDeviceEntry>
+{
+public:
+    enum Roles {
+        DeviceIdRole = Qt::UserRole + 1,
+        NameRole,
+        ConnectedRole,
+        HiddenRole
+    };
+
+    explicit HiddenDeviceListModel(QObject *parent = nullptr);
+
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void sync(const QVector<HiddenDeviceEntry> &entries) { syncRows(entries); }
+
+protected:
+    QString rowKey(const HiddenDeviceEntry &row) const override { return row.deviceId; }
+    QVector<int> updateRow(HiddenDeviceEntry &row, const HiddenDeviceEntry &next) override;
+};
+
+class HiddenProcessListModel final : public KeyedListModel<HiddenProcessEntry>
+{
+public:
+    enum Roles {
+        ExePathRole = Qt::UserRole + 1,
+        NameRole,
+        HiddenRole
+    };
+
+    explicit HiddenProcessListModel(QObject *parent = nullptr);
+
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void sync(const QVector<HiddenProcessEntry> &entries) { syncRows(entries); }
+
+protected:
+    QString rowKey(const HiddenProcessEntry &row) const override { return row.exePath; }
+    QVector<int> updateRow(HiddenProcessEntry &row, const HiddenProcessEntry &next) override;
+};
+
+class HiddenPerDeviceListModel final : public KeyedListModel<HiddenDeviceProcessesEntry>
+{
+public:
+    enum Roles {
+        DeviceIdRole = Qt::UserRole + 1,
+        NameRole,
+        ConnectedRole,
+        ProcessCountRole,
+        ProcessesModelRole
+    };
+
+    explicit HiddenPerDeviceListModel(QObject *parent = nullptr);
+
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void sync(const QVector<HiddenDeviceProcessesEntry> &entries) { syncRows(entries); }
+
+protected:
+    QString rowKey(const HiddenDeviceProcessesEntry &row) const override { return row.deviceId; }
+    QVector<int> updateRow(HiddenDeviceProcessesEntry &row, const HiddenDeviceProcessesEntry &next) override;
+    void prepareRow(HiddenDeviceProcessesEntry &row) override;
+    void releaseRow(HiddenDeviceProcessesEntry &row) override;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QHash>
+#include <QRegularExpression>
+#include <QSet>
+#include <QString>
+#include <QVariantMap>
+
+#include <vector>
+
+// Compiled form of the hidden-process rules in ConfigStore. Each rule string is one of:
+//   exact path      C:\Program Files\App\app.exe
+//   basename        app.exe                 (no path separator)
+//   directory       C:\Games\Launcher\      (trailing separator: everything below it)
+//   glob            C:\Games\*\*.exe, *helper*.exe   (* ? [..]; without a separator it matches the basename)
+// In a path glob * and ? never cross a separator; a glob that does not compile is ignored and
+// counted in stats(). Matching is case-insensitive and treats / and \ alike. Verdicts are cached
+// per executable path, so after the first sighting a session costs one hash lookup regardless
+// of rule count.
+class HiddenRuleMatcher
+{
+public:
+    // Per rule set; the cache is dropped and rebuilt when it fills up.
+    static constexpr int kMaxCachedVerdicts = 2048;
+
+    void compile(const QSet<QString> &global, const QHash<QString, QSet<QString>> &perDevice);
+
+    bool isHidden(const QString &deviceId, const QString &exePath) const;
+
+    // True for rules that can only match one exact path (so a change to them only affects that exe).
+    static bool isExactRule(const QString &rule);
+
+    // { rules, invalidRules, deviceRuleSets, cachedVerdicts, verdictHits, verdictMisses }
+    QVariantMap stats() const;
+
+    // Case-folded, with / as the only separator; the form rules and paths are compared in.
+    static QString normalize(const QString &path);
+
+private:
+    class RuleSet
+    {
+    public:
+        void add(const QString &rule);
+        void finalize();
+        bool isEmpty() const { return m_empty; }
+        bool matches(const QString &exePath) const;
+        int cachedVerdicts() const { return m_verdicts.size(); }
+        int invalidGlobs() const { return m_invalidGlobs; }
+
+        mutable quint64 hits = 0;
+        mutable quint64 misses = 0;
+
+    private:
+        struct TrieNode
+        {
+            QHash<QString, int> children; // path component -> node index
+            bool terminal = false;
+        };
+
+        bool matchUncached(const QString &normalizedPath) const;
+        bool underPrefix(const QString &normalizedPath) const;
+
+        QSet<QString> m_exact;
+        QSet<QString> m_basenames;
+        std::vector<TrieNode> m_trie{TrieNode{}};
+        QStringList m_pathGlobs;
+        QStringList m_nameGlobs;
+        QRegularExpression m_pathGlob;
+        QRegularExpression m_nameGlob;
+        int m_invalidGlobs = 0;
+        bool m_empty = true;
+
+        mutable QHash<QString, bool> m_verdicts; // raw exePath -> hidden
+    };
+
+    static QString baseName(const QString &normalizedPath);
+
+    RuleSet m_global;
+    QHash<QString, RuleSet> m_perDevice;
+    int m_ruleCount = 0;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QVariantMap>
+#include <QtGlobal>
+
+#include <array>
+#include <atomic>
+
+// Fixed-bucket latency histogram. Buckets are powers of two in microseconds
+// (bucket k holds samples in [2^(k-1), 2^k) us), so recording is a couple of relaxed
+// atomic ops and is safe from any thread (e.g. the scene graph render thread).
+class Histogram
+{
+public:
+    static constexpr int kBucketCount = 24; // up to ~8.4 s
+
+    Histogram();
+
+    void record(qint64 nanoseconds);
+    void reset();
+
+    quint64 count() const { return m_count.load(std::memory_order_relaxed); }
+    double meanMs() const;
+    double maxMs() const;
+    // Upper bound (ms) of the bucket containing the p-th percentile, p in [0, 1].
+    double percentileMs(double p) const;
+
+    // { count, meanMs, p50Ms, p90Ms, p99Ms, maxMs, buckets: [{ leMs, count }] }
+    QVariantMap toVariantMap() const;
+
+private:
+    static int bucketFor(qint64 nanoseconds);
+    static double bucketUpperMs(int bucket);
+
+    std::array<std::atomic<quint64>, kBucketCount> m_buckets;
+    std::atomic<quint64> m_count{0};
+    std::atomic<qint64> m_sumNs{0};
+    std::atomic<qint64> m_maxNs{0};
+};
@@ -4,22 +4,123 @@
 #include <QImage>
 #include <QMutex>
 #include <QQuickImageProvider>
+#include <QSet>
+#include <QThreadPool>
+#include <QVariantMap>
+
+#include <list>
+#include <memory>
+
+#include "IconDiskCache.h"
 
 class IconCache final : public QQuickImageProvider
 {
+    Q_OBJECT
 public:
+    // Entry cap alongside the byte budget; failed extractions hold no pixels.
+    static constexpr qsizetype kMaxEntries = 1024;
+
     IconCache();
+    ~IconCache() override;
+
+    // Shown until the real icon has been extracted.
+    static QString placeholderKey();
 
-    // Key is stable (exePath). QML uses: image://appicon/<url-escaped-key>
+    // Never blocks: returns the key QML should display right now (exePath once cached, otherwise
+    // placeholderKey()) and queues extraction on the icon pool. iconReady() fires when it lands.
+    // QML uses: image://appicon/<url-escaped-key>
     QString ensureIconForExePath(const QString &exePath);
+    // Warms the cache for an executable no row shows yet (worker's executableSeen). Does not
+    // count as a hit or miss.
+    void prefetch(const QString &exePath);
 
     QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+    // What the engine calls (the provider is Texture-typed): the same lookup as requestImage(),
+    // wrapped in an IconTextureFactory so icons share the scene graph's atlas texture.
+    QQuickTextureFactory *requestTexture(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+    // Memory budget for decoded icons. Least recently used unpinned icons are evicted past it,
+    // or past kMaxEntries entries (they come back from the disk store or the pool on the next
+    // request).
+    void setByteBudget(qint64 bytes);
+    // Texture requests that found no decoded icon (placeholder served), for first-paint tracking.
+    quint64 requestMisses() const;
+
+    // Icons of sessions currently in the UI; never evicted. Replaces the previous set.
+    void setPinnedExePaths(const QSet<QString> &exePaths);
+
+    // Writes icons.bin now (also on QCoreApplication::aboutToQuit); the destructor writes
+    // whatever changed after that.
+    void save();
+
+    // { hits, misses, diskHits, diskPruned, evictions, residentBytes, byteBudget, entries, pinned,
+    //   pending, reloadKeys, uniqueImages, dedupHits, logicalBytes, dedupRatio, prefetches,
+    //   requestMisses }
+    QVariantMap stats() const;
+
+signals:
+    void iconReady(const QString &exePath, const QString &iconKey);
 
 private:
-    QImage loadSmallIconForExePath(const QString &exePath) const;
+    void queueLoad(const QString &exePath);
+    void pruneStaleDiskEntries();
+    void queueRevalidate(const QString &exePath, const IconDiskCache::Stamp &stored);
+    void finishLoad(const QString &exePath, const QImage &img, const QVector<QImage> &variants,
+                    const IconDiskCache::Stamp &stamp);
+    QVector<int> variantSizes() const;
+    static QImage scaledVariant(const QImage &src, int px);
+    static QVector<QImage> makeVariants(const QImage &src, const QVector<int> &sizes);
+    static QImage loadSmallIconForExePath(const QString &exePath);
+    static QImage fallbackIcon();
+
+    // Pixels shared by every exePath whose icon hashes (and compares) equal, e.g. the many
+    // helper binaries of one browser.
+    struct ImageRecord {
+        QImage image;
+        QVector<QImage> variants; // pre-scaled copies, one per requested device-pixel size
+        qint64 bytes = 0;
+        size_t hash = 0;
+    };
+
+    struct Entry {
+        std::shared_ptr<ImageRecord> record; // null: extraction failed, served as fallbackIcon()
+        std::list<QString>::iterator lru;
+    };
+
+    // All *Locked helpers expect m_mutex to be held.
+    Entry *touchLocked(const QString &exePath);
+    void insertLocked(const QString &exePath, const QImage &img, QVector<QImage> variants = {});
+    std::shared_ptr<ImageRecord> recordForLocked(const QImage &img, QVector<QImage> variants);
+    void releaseLocked(Entry &e);
+    QImage variantLocked(Entry &e, int px);
+    // A copy if img aliases the mapped icon file; variants are handed out and must not.
+    QImage ownedLocked(const QImage &img) const;
+    void evictLocked();
 
     mutable QMutex m_mutex;
-    QHash<QString, QImage> m_cache; // exePath -> image
-};
+    QHash<QString, Entry> m_cache; // exePath -> image
+    QHash<size_t, std::weak_ptr<ImageRecord>> m_recordByHash; // content hash -> live record
+    std::list<QString> m_lru;      // most recently used first
+    QSet<QString> m_pinned;
+    QVector<int> m_variantSizes; // device-pixel sizes QML has requested (one per DPI in use)
+    qint64 m_byteBudget = 4 * 1024 * 1024;
+    qint64 m_residentBytes = 0;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+    quint64 m_diskHits = 0;
+    quint64 m_diskPruned = 0;
+    quint64 m_evictions = 0;
+    quint64 m_dedupHits = 0;
+    quint64 m_prefetches = 0;
+    quint64 m_requestMisses = 0;
+
+    QSet<QString> m_pending;        // exePaths queued or being extracted
+    QHash<QString, QString> m_keyByPath; // exePath -> reload key, only for replaced icons
+    quint32 m_generation = 0;
 
+    // Persisted icons from earlier runs (path + size + mtime); loaded at construction.
+    IconDiskCache m_disk;
 
+    // Shell icon extraction only ever runs here, never on the GUI thread.
+    QThreadPool m_pool;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QString>
+
+// On-disk icon store (AppData/icons.bin): a fixed-size index followed by raw ARGB32 pixels
+// (identical icons share one block) and UTF-16 paths. The file is memory-mapped on load and
+// lookups wrap the mapped pixels without copying. Entries carry the exe's size + mtime so
+// callers can tell when one has gone stale. Not thread-safe; IconCache serializes access.
+class IconDiskCache
+{
+public:
+    struct Stamp {
+        qint64 size = -1; // -1: file missing
+        qint64 mtimeMs = 0;
+
+        bool operator==(const Stamp &o) const { return size == o.size && mtimeMs == o.mtimeMs; }
+        bool operator!=(const Stamp &o) const { return !(*this == o); }
+    };
+
+    IconDiskCache();
+    ~IconDiskCache();
+
+    IconDiskCache(const IconDiskCache &) = delete;
+    IconDiskCache &operator=(const IconDiskCache &) = delete;
+
+    static QString filePath();
+    // Stats the executable (does disk I/O; keep off the GUI thread where possible).
+    static Stamp stampFor(const QString &exePath);
+
+    void load();
+    bool lookup(const QString &exePath, QImage *img, Stamp *stamp) const;
+    void put(const QString &exePath, const Stamp &stamp, const QImage &img);
+    void remove(const QString &exePath);
+    // Path -> stamp of every stored entry (for pruning stale ones off the GUI thread).
+    QHash<QString, Stamp> stamps() const;
+
+    // True if img aliases the mapped file (must be copied before it can outlive the cache).
+    bool isMapped(const QImage &img) const;
+
+    // Writes the store back if anything changed. The file cannot be replaced while mapped, so
+    // the entries are first copied out of the mapping and it is released; every image handed
+    // out by lookup() that was not copied is invalid afterwards. The entries stay usable.
+    void save();
+    // save(), then drops the entries.
+    void saveAndClose();
+
+private:
+    struct Entry {
+        Stamp stamp;
+        QImage image;
+    };
+
+    QByteArray serialize() const;
+    void unmap();
+
+    QFile m_file;
+    uchar *m_map = nullptr;
+    qint64 m_mapSize = 0;
+    QHash<QString, Entry> m_entries;
+    bool m_dirty = false;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QImage>
+#include <QQuickTextureFactory>
+#include <QVariantMap>
+
+// Texture path for IconCache: icons are uploaded with TextureCanUseAtlas (what Qt already does
+// for image-provider images), so session icons become sub-rects of the scene graph's shared
+// atlas texture. Live textures are tracked to report how many GPU textures icons occupy.
+class IconTextureFactory final : public QQuickTextureFactory
+{
+    Q_OBJECT
+public:
+    explicit IconTextureFactory(const QImage &image);
+
+    QSGTexture *createTexture(QQuickWindow *window) const override;
+    QSize textureSize() const override { return m_image.size(); }
+    int textureByteCount() const override { return int(m_image.sizeInBytes()); }
+    QImage image() const override { return m_image; }
+
+    // { liveIconTextures, atlasBacked, standalone, distinctIconTextures }
+    // distinctIconTextures is the number of underlying GPU textures behind the live icons (1 when
+    // everything landed in the atlas). It is not a draw-call count: the renderer exposes none, so
+    // batches are only visible in the QSG_RENDERER_DEBUG=render log.
+    static QVariantMap stats();
+
+private:
+    QImage m_image;
+};
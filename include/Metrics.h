@@ -0,0 +1,99 @@
+#pragma once
+
+#include <QByteArray>
+#include <QMutex>
+#include <QPointer>
+#include <QString>
+#include <QVariantMap>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "Histogram.h"
+
+// Process-wide runtime metrics: named counters, gauges and latency histograms, plus "sources"
+// that fold the existing per-component stats maps into the same snapshot. Looking a metric up
+// by name takes a lock, so hot paths resolve it once into a function-local static reference and
+// afterwards an update is a relaxed atomic op or two, cheap enough to leave on in release builds.
+class Metrics
+{
+public:
+    class Counter
+    {
+    public:
+        void add(quint64 n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+        quint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<quint64> m_value{0};
+    };
+
+    class Gauge
+    {
+    public:
+        void set(qint64 v) { m_value.store(v, std::memory_order_relaxed); }
+        qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<qint64> m_value{0};
+    };
+
+    // Records the time until end of scope into a histogram.
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Histogram &h)
+            : m_histogram(h)
+            , m_startNs(nowNs())
+        {
+        }
+        ~ScopedTimer() { m_histogram.record(nowNs() - m_startNs); }
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        Histogram &m_histogram;
+        qint64 m_startNs;
+    };
+
+    // Monotonic nanoseconds, comparable across threads (for latencies that span a queue hop).
+    static qint64 nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static Metrics &instance();
+
+    // Created on first use; the returned reference stays valid for the process lifetime.
+    Counter &counter(const QString &name);
+    Gauge &gauge(const QString &name);
+    Histogram &histogram(const QString &name);
+
+    // Stats provider evaluated on the GUI thread at snapshot time; dropped once owner is destroyed.
+    void addSource(const QString &name, QObject *owner, std::function<QVariantMap()> fn);
+
+    // { counters: {name: n}, gauges: {name: v}, histograms: {name: {...}}, sources: {name: {...}} }
+    QVariantMap snapshot() const;
+    QByteArray toJson() const;
+    void resetHistograms();
+
+private:
+    Metrics() = default;
+
+    struct Source
+    {
+        QString name;
+        QPointer<QObject> owner;
+        std::function<QVariantMap()> fn;
+    };
+
+    mutable QMutex m_lock;
+    std::map<QString, std::unique_ptr<Counter>> m_counters;
+    std::map<QString, std::unique_ptr<Gauge>> m_gauges;
+    std::map<QString, std::unique_ptr<Histogram>> m_histograms;
+    std::vector<Source> m_sources;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QtGlobal>
+
+// What AudioWorker carries from one snapshot to the next: when each (device, pid, exe) session
+// was last active, and which executables it has already announced through executableSeen. A
+// complete snapshot pass (beginPass() .. commitPass()) replaces both with what it noted, so
+// sessions and executables that went away are forgotten; an abandoned pass changes nothing.
+// Worker thread only.
+class SessionHistory
+{
+public:
+    void beginPass();
+    void commitPass();
+
+    // Last-active time (epoch ms, 0 = never) to report for a session of the current pass; an
+    // active session is stamped nowMs.
+    qint64 noteSession(const QString &deviceId, quint32 pid, const QString &exePath, bool active, qint64 nowMs);
+    // True the first time exePath shows up since it was last missing from a complete pass.
+    // Also valid between passes (sessions created since the last snapshot).
+    bool noteExecutable(const QString &exePath);
+
+    int lastActiveEntries() const { return int(m_lastActive.size()); }
+    int seenExecutables() const { return int(m_seen.size()); }
+
+private:
+    QHash<QString, qint64> m_lastActive; // "deviceId|pid|exePath" -> epoch ms
+    QSet<QString> m_seen;
+    bool m_inPass = false;
+    QHash<QString, qint64> m_passLastActive;
+    QSet<QString> m_passSeen;
+};
@@ -1,40 +1,104 @@
 #pragma once
 
 #include <QAbstractListModel>
-#include <QPointer>
+#include <QHash>
+#include <QSet>
+#include <QString>
 #include <QVector>
 
-class AudioSession;
+class AudioBackend;
 
+// Session rows for one device. State is kept as parallel arrays (one entry per row) rather than
+// one QObject per session; QML reads it through roles and writes through the row-taking
+// invokables below.
 class SessionListModel final : public QAbstractListModel
 {
+    Q_OBJECT
 public:
     enum Roles {
-        SessionObjectRole = Qt::UserRole + 1,
-        PidRole,
+        PidRole = Qt::UserRole + 1,
+        DeviceIdRole,
         ExePathRole,
         DisplayNameRole,
         IconKeyRole,
         VolumeRole,
-        MutedRole
+        MutedRole,
+        ActiveRole,
+        PeakRole
     };
 
-    explicit SessionListModel(QObject *parent = nullptr);
+    struct Fields {
+        quint32 pid = 0;
+        QString exePath;
+        QString displayName;
+        QString iconKey;
+        double volume = 1.0; // 0..1
+        bool muted = false;
+        bool active = false;
+    };
+
+    explicit SessionListModel(AudioBackend *backend, const QString &deviceId, QObject *parent = nullptr);
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role) const override;
     QHash<int, QByteArray> roleNames() const override;
 
-    QVector<AudioSession *> sessions() const { return m_sessions; }
-    AudioSession *sessionAt(int row) const;
+    static QString sessionKey(quint32 pid, const QString &exePath);
+
+    QString deviceId() const { return m_deviceId; }
     int indexOf(quint32 pid, const QString &exePath) const;
 
-    void insertSession(int row, AudioSession *session);
-    void removeSessionAt(int row);
+    quint32 pidAt(int row) const { return m_pid.at(row); }
+    QString exePathAt(int row) const { return m_exePath.at(row); }
+    QString displayNameAt(int row) const { return m_displayName.at(row); }
+    double volumeAt(int row) const { return m_volume.at(row); }
+    bool mutedAt(int row) const { return m_flags.at(row) & MutedFlag; }
+    int countIconKey(const QString &iconKey) const { return int(m_iconKey.count(iconKey)); }
+    // Entries in the key -> row index; equal to rowCount() unless the index leaks.
+    int indexedRows() const { return int(m_rowByKey.size()); }
+
+    // Updates the row for fields.pid/exePath, appending it when missing. Returns true on insert.
+    bool upsert(const Fields &fields);
+    // Drops every row whose sessionKey() is not in keepKeys. Returns the number removed.
+    int removeAllExcept(const QSet<QString> &keepKeys);
     void clear();
 
+    void setVolumeAt(int row, double v);
+    void setMutedAt(int row, bool m);
+    void setPeakAt(int row, double p);
+    // Icons resolve asynchronously; swaps the key on every row showing this executable.
+    void setIconKeyForExePath(const QString &exePath, const QString &iconKey);
+
+    Q_INVOKABLE void setVolume(int row, double v);
+    Q_INVOKABLE void setMuted(int row, bool m);
+    Q_INVOKABLE void toggleMute(int row);
+
 private:
-    QVector<AudioSession *> m_sessions;
-};
+    enum RowFlag : quint8 {
+        MutedFlag = 0x1,
+        ActiveFlag = 0x2
+    };
+
+    bool validRow(int row) const { return row >= 0 && row < m_pid.size() - m_gapSize; }
+    void setFlag(int row, RowFlag flag, bool on, int role);
+    void emitRowChanged(int row, const QVector<int> &roles);
+    void rebuildIndex();
 
+    AudioBackend *m_backend = nullptr;
+    QString m_deviceId;
 
+    QVector<quint32> m_pid;
+    QVector<QString> m_exePath;
+    QVector<QString> m_displayName;
+    QVector<QString> m_iconKey;
+    QVector<float> m_volume;
+    QVector<float> m_peak;
+    QVector<quint8> m_flags;
+
+    // Rows [m_gapStart, m_gapStart + m_gapSize) are dead; only non-empty inside removeAllExcept().
+    int m_gapStart = 0;
+    int m_gapSize = 0;
+
+    // sessionKey -> row
+    QHash<QString, int> m_rowByKey;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+struct DeviceState;
+
+// Last known audio state (AppData/state.bin): devices with name/default/volume/mute and their
+// sessions, written on exit so the next launch can show the flyout before COM has produced its
+// first snapshot. Versioned binary QDataStream; any mismatch or damage reads as empty.
+namespace StateCache {
+
+QString filePath();
+QVector<DeviceState> load();
+bool save(const QVector<DeviceState> &devices);
+
+} // namespace StateCache
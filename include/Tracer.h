@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+#include <atomic>
+
+// Opt-in Chrome trace-event recorder for the audio -> GUI pipeline. Each thread appends to its
+// own fixed-size ring (no locks, no allocation after that thread's first event); a thread that
+// exits hands its ring on to the next new one. Export merges the rings into trace_event JSON for
+// chrome://tracing or Perfetto. Names must be string
+// literals. Flow ids tie the stages one change passes through on different threads into arrows.
+// While tracing is off every call costs one relaxed load.
+class Tracer
+{
+public:
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+    // Starting discards whatever was recorded before.
+    static void start();
+    static void stop();
+    // Events since the last start(). Exact after stop(); while running, the oldest slots of a
+    // ring that has wrapped may be mid-overwrite and are left out.
+    static QByteArray exportJson();
+    static bool saveTo(const QString &path);
+
+    // Label for the calling thread in the trace (string literal).
+    static void setThreadName(const char *name);
+
+    static void begin(const char *name)
+    {
+        if (enabled())
+            record('B', name, 0);
+    }
+    static void end(const char *name)
+    {
+        if (enabled())
+            record('E', name, 0);
+    }
+    static void instant(const char *name)
+    {
+        if (enabled())
+            record('i', name, 0);
+    }
+
+    // 0 while tracing is off; the flow calls ignore id 0. A flow event binds to the innermost
+    // span open on its thread.
+    static quint64 newFlowId() { return enabled() ? s_nextFlowId.fetch_add(1, std::memory_order_relaxed) : 0; }
+    static void flowStart(quint64 id)
+    {
+        if (id && enabled())
+            record('s', nullptr, id);
+    }
+    static void flowStep(quint64 id)
+    {
+        if (id && enabled())
+            record('t', nullptr, id);
+    }
+    static void flowEnd(quint64 id)
+    {
+        if (id && enabled())
+            record('f', nullptr, id);
+    }
+
+    // Hand-off to the render thread: the flow the next presented frame completes.
+    static void setFrameFlow(quint64 id)
+    {
+        if (id)
+            s_frameFlowId.store(id, std::memory_order_relaxed);
+    }
+    static quint64 takeFrameFlow() { return s_frameFlowId.exchange(0, std::memory_order_relaxed); }
+
+    class Span
+    {
+    public:
+        explicit Span(const char *name)
+            : m_name(enabled() ? name : nullptr)
+        {
+            if (m_name)
+                record('B', m_name, 0);
+        }
+        // Closed even if tracing stopped meanwhile, so spans stay balanced.
+        ~Span()
+        {
+            if (m_name)
+                record('E', m_name, 0);
+        }
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+
+    private:
+        const char *m_name;
+    };
+
+private:
+    static void record(char phase, const char *name, quint64 id);
+
+    static std::atomic<bool> s_enabled;
+    static std::atomic<quint64> s_nextFlowId;
+    static std::atomic<quint64> s_frameFlowId;
+};
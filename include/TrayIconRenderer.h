@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QHash>
+#include <QIcon>
+#include <QImage>
+#include <QString>
+#include <QVector>
+
+// Pre-rasterized tray icons. Every visible state (quantized level x muted) is drawn once per tray
+// pixel size, so a volume change is a hash lookup instead of decoding an .ico, and callers can
+// compare pixelKey() to skip QSystemTrayIcon::setIcon when nothing on screen would change.
+class TrayIconRenderer
+{
+public:
+    enum class Style {
+        Buckets, // the four vol_N.ico glyphs
+        Levels,  // speaker glyph + 10-step level bar
+        Percent  // numeric volume
+    };
+
+    static Style styleFromString(const QString &s);
+    static QString styleToString(Style s);
+
+    Style style() const { return m_style; }
+    // Drops the cache; call prewarm() afterwards.
+    void setStyle(Style s);
+
+    // Device-pixel edge lengths of the tray icon on the current screens.
+    QVector<int> traySizes() const { return m_traySizes; }
+    // Returns true if the set changed (and the cache was dropped).
+    bool setTraySizes(QVector<int> sizes);
+    // Tray sizes derived from every connected screen's device pixel ratio.
+    static QVector<int> traySizesForScreens();
+
+    // Rasterizes every state of the current style at every tray size.
+    void prewarm();
+
+    // Quantized visible level for the current style (-1 never returned; muted is separate).
+    int levelFor(double volume01) const;
+
+    QIcon icon(int level, bool muted);
+    // Hash over the pixels of all sizes for this state; equal keys look identical in the tray.
+    size_t pixelKey(int level, bool muted);
+
+    int cachedStates() const { return m_states.size(); }
+
+private:
+    struct State
+    {
+        QIcon icon;
+        size_t pixelKey = 0;
+    };
+
+    static quint32 stateKey(int level, bool muted) { return (quint32(level) << 1) | (muted ? 1u : 0u); }
+    int levelCount() const;
+    const State &stateFor(int level, bool muted);
+    QImage render(int level, bool muted, int px) const;
+
+    Style m_style = Style::Buckets;
+    QVector<int> m_traySizes{16};
+    QHash<quint32, State> m_states;
+};
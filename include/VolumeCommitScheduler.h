@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include "VolumeTarget.h"
+
+// One shared debounce for slider drags: rows mark a target dirty, a single 16 ms tick drains
+// every pending target (last value wins per target) and hands them over as one batch.
+class VolumeCommitScheduler final : public QObject
+{
+    Q_OBJECT
+public:
+    explicit VolumeCommitScheduler(QObject *parent = nullptr);
+
+    void schedule(const VolumeTarget &target);
+    bool hasPending() const { return !m_pending.isEmpty(); }
+
+signals:
+    void batchReady(const QVector<VolumeTarget> &targets);
+
+private:
+    void flush();
+
+    QTimer m_timer;
+    QVector<VolumeTarget> m_pending;
+    // target key -> index in m_pending
+    QHash<QString, int> m_indexByKey;
+};
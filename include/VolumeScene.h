@@ -0,0 +1,20 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+#include "VolumeTarget.h"
+
+// A named set of device and session levels ("meeting", "gaming"), captured from the current audio
+// state and applied as one batched worker call. Session targets carry pid 0 and match every
+// session of that executable on the device, since pids do not survive an app restart.
+struct VolumeScene
+{
+    QString name;
+    QVector<VolumeTarget> targets;
+
+    bool operator==(const VolumeScene &o) const { return name == o.name && targets == o.targets; }
+    bool operator!=(const VolumeScene &o) const { return !(*this == o); }
+};
+
+using VolumeSceneList = QVector<VolumeScene>;
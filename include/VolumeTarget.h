@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+// One pending volume write; device endpoint or a single session on it.
+struct VolumeTarget
+{
+    enum class Kind { Device, Session };
+
+    Kind kind = Kind::Device;
+    QString deviceId;
+    quint32 pid = 0; // sessions only; 0 = every session of exePath on the device (scenes)
+    QString exePath; // sessions only
+    double volume = 1.0; // 0..1
+    bool applyMute = false; // slider commits leave mute alone; scenes set it too
+    bool muted = false;
+    // Metrics::nowNs() of the first slider input folded into this target (0 = unstamped);
+    // feeds the slider -> COM write latency. Not part of the target's identity.
+    qint64 requestedAtNs = 0;
+
+    bool operator==(const VolumeTarget &o) const
+    {
+        return kind == o.kind && deviceId == o.deviceId && pid == o.pid && exePath == o.exePath
+            && qFuzzyCompare(volume + 1.0, o.volume + 1.0) && applyMute == o.applyMute && muted == o.muted;
+    }
+    bool operator!=(const VolumeTarget &o) const { return !(*this == o); }
+};
+
+Q_DECLARE_METATYPE(VolumeTarget)
+Q_DECLARE_METATYPE(QVector<VolumeTarget>)
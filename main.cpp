@@ -5,6 +5,7 @@
 #include <QSharedMemory>
 
 #include "AppController.h"
+#include "Tracer.h"
 
 int main(int argc, char *argv[])
 {
@@ -25,6 +26,17 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    // EARIE_TRACE=<file.json>: trace from launch and write the Chrome trace there on exit.
+    Tracer::setThreadName("gui");
+    const QString tracePath = qEnvironmentVariable("EARIE_TRACE");
+    if (!tracePath.isEmpty()) {
+        Tracer::start();
+        QObject::connect(&app, &QCoreApplication::aboutToQuit, [tracePath]() {
+            Tracer::stop();
+            Tracer::saveTo(tracePath);
+        });
+    }
+
     AppController controller;
     if (!controller.init()) {
         return 1;
@@ -21,30 +21,14 @@ Item {
 
     Styles.Theme { id: theme }
 
-    property var hiddenDevices: []
-    property var globalProcesses: []
-    property var perDeviceProcesses: []
+    // Backed by persistent C++ models (hiddenDevicesModel, hiddenProcessesGlobalModel,
+    // hiddenProcessesPerDeviceModel) that update row-by-row, so delegates are not rebuilt
+    // when a single item toggles.
     property var perDeviceExpandedMap: ({})
     property bool devicesExpanded: true
     property bool globalExpanded: true
     property bool perDeviceExpanded: true
 
-    function refreshModels() {
-        if (!appController)
-            return
-        hiddenDevices = appController.hiddenDevicesSnapshot() || []
-        globalProcesses = appController.hiddenProcessesGlobalSnapshot() || []
-        perDeviceProcesses = appController.hiddenProcessesPerDeviceSnapshot() || []
-        var nextMap = {}
-        for (var i = 0; i < perDeviceProcesses.length; ++i) {
-            var id = perDeviceProcesses[i].deviceId
-            if (id && perDeviceExpandedMap[id] === true)
-                nextMap[id] = true
-        }
-        perDeviceExpandedMap = nextMap
-        appController.requestHiddenItemsRelayout()
-    }
-
     function isPerDeviceExpanded(id) {
         return perDeviceExpandedMap[id] === true
     }
@@ -58,14 +42,6 @@ Item {
         perDeviceExpandedMap = nextMap
     }
 
-    Component.onCompleted: refreshModels()
-    onVisibleChanged: if (visible) refreshModels()
-
-    Connections {
-        target: appController
-        function onHiddenItemsChanged() { refreshModels() }
-    }
-
     Rectangle {
         anchors.fill: parent
         radius: theme.radius
@@ -97,6 +73,30 @@ Item {
                 text: "Hidden items"
             }
 
+            ToolButton {
+                id: unhideAllBtn
+                Layout.preferredHeight: 28
+                padding: 0
+                leftPadding: 8
+                rightPadding: 8
+                text: "Unhide all"
+                font.pixelSize: 12
+
+                contentItem: Text {
+                    text: unhideAllBtn.text
+                    font: unhideAllBtn.font
+                    color: theme.textMuted
+                    verticalAlignment: Text.AlignVCenter
+                }
+
+                background: Rectangle {
+                    radius: 8
+                    color: unhideAllBtn.hovered ? theme.cellHover : "transparent"
+                }
+
+                onClicked: if (appController) appController.unhideAll()
+            }
+
             ToolButton {
                 id: closeBtn
                 Layout.preferredWidth: 28
@@ -165,14 +165,15 @@ Item {
                     }
 
                     Text {
-                        visible: devicesExpanded && hiddenDevices.length === 0
+                        visible: devicesExpanded && devicesRepeater.count === 0
                         color: theme.textMuted
                         font.pixelSize: 11
                         text: "(No devices)"
                     }
 
                     Repeater {
-                        model: devicesExpanded ? hiddenDevices : []
+                        id: devicesRepeater
+                        model: devicesExpanded ? hiddenDevicesModel : null
                         delegate: Rectangle {
                             width: parent.width
                             height: 34
@@ -186,7 +187,7 @@ Item {
                                 anchors.fill: parent
                                 hoverEnabled: true
                                 cursorShape: Qt.PointingHandCursor
-                                onClicked: if (appController) appController.setDeviceHidden(modelData.deviceId, !modelData.hidden)
+                                onClicked: if (appController) appController.setDeviceHidden(model.deviceId, !model.hidden)
                             }
 
                             Rectangle {
@@ -197,9 +198,9 @@ Item {
                                 anchors.leftMargin: 10
                                 anchors.verticalCenter: parent.verticalCenter
                                 border.width: 1
-                                border.color: modelData.hidden ? Qt.rgba(0.23, 0.59, 1.0, 0.95)
+                                border.color: model.hidden ? Qt.rgba(0.23, 0.59, 1.0, 0.95)
                                                      : Qt.rgba(1, 1, 1, 0.22)
-                                color: modelData.hidden ? Qt.rgba(0.23, 0.59, 1.0, 0.75)
+                                color: model.hidden ? Qt.rgba(0.23, 0.59, 1.0, 0.75)
                                               : "transparent"
 
                                 Rectangle {
@@ -208,12 +209,12 @@ Item {
                                     height: 6
                                     radius: 1
                                     color: "white"
-                                        visible: modelData.hidden
+                                        visible: model.hidden
                                 }
                             }
 
                             Text {
-                                text: modelData.connected ? modelData.name : "[disconnected] " + modelData.name
+                                text: model.connected ? model.name : "[disconnected] " + model.name
                                 anchors.left: parent.left
                                 anchors.leftMargin: 30
                                 anchors.right: parent.right
@@ -278,14 +279,15 @@ Item {
                         }
 
                         Text {
-                            visible: globalProcesses.length === 0
+                            visible: globalRepeater.count === 0
                             color: theme.textMuted
                             font.pixelSize: 11
                             text: "(No processes)"
                         }
 
-                    Repeater {
-                            model: globalProcesses
+                        Repeater {
+                            id: globalRepeater
+                            model: hiddenProcessesGlobalModel
                             delegate: Rectangle {
                                 width: parent.width
                                 height: 34
@@ -299,7 +301,7 @@ Item {
                                     anchors.fill: parent
                                     hoverEnabled: true
                                     cursorShape: Qt.PointingHandCursor
-                                    onClicked: if (appController) appController.setProcessHiddenGlobal(modelData.exePath, !modelData.hidden)
+                                    onClicked: if (appController) appController.setProcessHiddenGlobal(model.exePath, !model.hidden)
                                 }
 
                                 Rectangle {
@@ -310,9 +312,9 @@ Item {
                                     anchors.leftMargin: 10
                                     anchors.verticalCenter: parent.verticalCenter
                                     border.width: 1
-                                    border.color: modelData.hidden ? Qt.rgba(0.23, 0.59, 1.0, 0.95)
+                                    border.color: model.hidden ? Qt.rgba(0.23, 0.59, 1.0, 0.95)
                                                          : Qt.rgba(1, 1, 1, 0.22)
-                                    color: modelData.hidden ? Qt.rgba(0.23, 0.59, 1.0, 0.75)
+                                    color: model.hidden ? Qt.rgba(0.23, 0.59, 1.0, 0.75)
                                                   : "transparent"
 
                                     Rectangle {
@@ -321,12 +323,12 @@ Item {
                                         height: 6
                                         radius: 1
                                         color: "white"
-                                        visible: modelData.hidden
+                                        visible: model.hidden
                                     }
                                 }
 
                                 Text {
-                                    text: modelData.name
+                                    text: model.name
                                     anchors.left: parent.left
                                     anchors.leftMargin: 30
                                     anchors.right: parent.right
@@ -352,19 +354,22 @@ Item {
                         }
 
                         Text {
-                            visible: perDeviceProcesses.length === 0
+                            visible: perDeviceRepeater.count === 0
                             color: theme.textMuted
                             font.pixelSize: 11
                             text: "(No devices)"
                         }
 
                         Repeater {
-                            model: perDeviceProcesses
+                            id: perDeviceRepeater
+                            model: hiddenProcessesPerDeviceModel
                             delegate: Column {
                                 width: parent.width
                                 spacing: 6
                                 readonly property bool expanded: root.isPerDeviceExpanded(deviceId)
-                                property string deviceId: modelData.deviceId
+                                property string deviceId: model.deviceId
+                                property var processesModel: model.processesModel
+                                property int processCount: model.processCount
 
                                 Item {
                                     width: parent.width
@@ -391,7 +396,7 @@ Item {
                                     Text {
                                         color: theme.textMuted
                                         font.pixelSize: 11
-                                        text: modelData.connected ? modelData.name : "[disconnected] " + modelData.name
+                                        text: model.connected ? model.name : "[disconnected] " + model.name
                                         anchors.left: parent.left
                                         anchors.leftMargin: 18
                                         anchors.verticalCenter: parent.verticalCenter
@@ -400,14 +405,14 @@ Item {
                                 }
 
                                 Text {
-                                    visible: expanded && (!modelData.processes || modelData.processes.length === 0)
+                                    visible: expanded && processCount === 0
                                     color: theme.textMuted
                                     font.pixelSize: 11
                                     text: "(No processes)"
                                 }
 
                                 Repeater {
-                                    model: expanded ? (modelData.processes || []) : []
+                                    model: expanded ? processesModel : null
                                     delegate: Rectangle {
                                         width: parent.width
                                         height: 34
@@ -421,7 +426,7 @@ Item {
                                             anchors.fill: parent
                                             hoverEnabled: true
                                             cursorShape: Qt.PointingHandCursor
-                                            onClicked: if (appController) appController.setProcessHiddenForDevice(deviceId, modelData.exePath, !modelData.hidden)
+                                            onClicked: if (appController) appController.setProcessHiddenForDevice(deviceId, model.exePath, !model.hidden)
                                         }
 
                                         Rectangle {
@@ -432,9 +437,9 @@ Item {
                                             anchors.leftMargin: 10
                                             anchors.verticalCenter: parent.verticalCenter
                                             border.width: 1
-                                            border.color: modelData.hidden ? Qt.rgba(0.23, 0.59, 1.0, 0.95)
+                                            border.color: model.hidden ? Qt.rgba(0.23, 0.59, 1.0, 0.95)
                                                                           : Qt.rgba(1, 1, 1, 0.22)
-                                            color: modelData.hidden ? Qt.rgba(0.23, 0.59, 1.0, 0.75)
+                                            color: model.hidden ? Qt.rgba(0.23, 0.59, 1.0, 0.75)
                                                                     : "transparent"
 
                                             Rectangle {
@@ -443,12 +448,12 @@ Item {
                                                 height: 6
                                                 radius: 1
                                                 color: "white"
-                                                visible: modelData.hidden
+                                                visible: model.hidden
                                             }
                                         }
 
                                         Text {
-                                            text: modelData.name
+                                            text: model.name
                                             anchors.left: parent.left
                                             anchors.leftMargin: 30
                                             anchors.right: parent.right
@@ -26,6 +26,17 @@ Item {
         if (appController) appController.requestRelayout()
     }
 
+    // Called from C++ while the flyout is hidden: a hidden window never polishes, so force the
+    // list (and each device's session list) to lay out now instead of on the first shown frame.
+    function prewarmLayout() {
+        listView.forceLayout()
+        for (let i = 0; i < listView.count; ++i) {
+            const it = listView.itemAtIndex(i)
+            if (it) it.forceLayout()
+        }
+        listView.forceLayout()
+    }
+
     Styles.Theme { id: theme }
 
     // Ensure any open QML menus are closed when the app loses focus (e.g. click desktop).
@@ -110,6 +121,27 @@ Item {
                         text: (appController && appController.scrollWheelVolumeOnHover ? "✓ " : "") + "Scroll wheel changes volume on hover (2%)"
                         onTriggered: if (appController) appController.scrollWheelVolumeOnHover = !appController.scrollWheelVolumeOnHover
                     }
+                    StyledMenuItem {
+                        text: (appController && appController.trayIconStyle === "buckets" ? "✓ " : "") + "Tray icon: volume bars"
+                        onTriggered: if (appController) appController.trayIconStyle = "buckets"
+                    }
+                    StyledMenuItem {
+                        text: (appController && appController.trayIconStyle === "levels" ? "✓ " : "") + "Tray icon: level meter"
+                        onTriggered: if (appController) appController.trayIconStyle = "levels"
+                    }
+                    StyledMenuItem {
+                        text: (appController && appController.trayIconStyle === "percent" ? "✓ " : "") + "Tray icon: percentage"
+                        onTriggered: if (appController) appController.trayIconStyle = "percent"
+                    }
+                    StyledMenuItem {
+                        text: (appController && appController.rememberAppVolumes ? "✓ " : "") + "Remember app volumes"
+                        onTriggered: if (appController) appController.rememberAppVolumes = !appController.rememberAppVolumes
+                    }
+                    StyledMenuItem {
+                        text: (appController && appController.rememberAppVolumesPerDevice ? "✓ " : "") + "Remember app volumes per device"
+                        enabled: appController && appController.rememberAppVolumes
+                        onTriggered: if (appController) appController.rememberAppVolumesPerDevice = !appController.rememberAppVolumesPerDevice
+                    }
                 }
             }
 
@@ -139,6 +171,10 @@ Item {
             spacing: 10
             boundsBehavior: Flickable.StopAtBounds
             model: deviceModel
+            // Rows restored from the last run until the first live snapshot replaces them. Their
+            // PIDs are from the previous boot, so they are read-only until then.
+            opacity: audioBackend && audioBackend.stale ? 0.6 : 1.0
+            enabled: !(audioBackend && audioBackend.stale)
             // Smoothly keep equal spacing while reordering.
             moveDisplaced: Transition {
                 NumberAnimation { properties: "x,y"; duration: 120; easing.type: Easing.OutCubic }
@@ -218,6 +254,8 @@ Item {
                 property int _lastTargetIndex: -1
                 property real _dragStartY: 0
 
+                function forceLayout() { cell.forceLayout() }
+
                 DeviceCell {
                     id: cell
                     anchors.fill: parent
@@ -10,6 +10,11 @@ Item {
     property string title: deviceObject ? deviceObject.name : ""
     property bool isDefault: deviceObject ? deviceObject.isDefault : false
     property var sessionsModel: deviceObject ? deviceObject.sessionsModel : null
+    // Upper bound on realized session rows per device (the rest are reached by scrolling).
+    property int maxVisibleSessions: 8
+    readonly property int sessionRowHeight: 34
+
+    function forceLayout() { sessionsList.forceLayout() }
 
     Styles.Theme { id: theme }
 
@@ -67,17 +72,38 @@ Item {
             deviceObject: root.deviceObject
         }
 
-        Column {
+        // Virtualized: only rows inside the viewport are realized, and delegates are pooled and
+        // reused as sessions come and go. Past maxVisibleSessions the list scrolls in place
+        // instead of growing the cell, which caps the number of live SessionRows per device.
+        ListView {
             id: sessionsList
             width: parent.width
+            height: implicitHeight
+            implicitHeight: {
+                const rows = Math.min(count, root.maxVisibleSessions)
+                return rows > 0 ? rows * root.sessionRowHeight + (rows - 1) * spacing : 0
+            }
             spacing: 4
-
-            Repeater {
-                model: root.sessionsModel
-                delegate: SessionRow {
-                    width: sessionsList.width
-                    sessionObject: model.sessionObject
-                }
+            clip: true
+            reuseItems: true
+            cacheBuffer: 0
+            interactive: count > root.maxVisibleSessions
+            boundsBehavior: Flickable.StopAtBounds
+            model: root.sessionsModel
+
+            delegate: SessionRow {
+                width: sessionsList.width
+                height: root.sessionRowHeight
+                sessions: root.sessionsModel
+                row: index
+                deviceId: model.deviceId
+                exePath: model.exePath
+                displayName: model.displayName
+                iconKey: model.iconKey
+                volume: model.volume
+                muted: model.muted
+                active: model.active
+                peak01: model.peak
             }
         }
     }
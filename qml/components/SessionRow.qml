@@ -7,8 +7,19 @@ import "../styles" as Styles
 
 Item {
     id: root
-    property var sessionObject
-    readonly property real peak01: sessionObject ? sessionObject.peak : 0
+    // Row state comes from SessionListModel roles; writes go back through the model's
+    // row-taking invokables (there is no per-session QObject).
+    property var sessions
+    property int row: -1
+    property string deviceId
+    property string exePath
+    property string displayName
+    property string iconKey
+    property real volume: 1.0
+    property bool muted: false
+    property bool active: true
+    property real peak01: 0
+    readonly property bool bound: sessions !== null && sessions !== undefined && row >= 0
     property bool _wheelAdjusting: false
 
     Styles.Theme { id: theme }
@@ -32,7 +43,30 @@ Item {
     }
 
     height: 34
-    opacity: sessionObject && sessionObject.active === false ? 0.82 : 1.0
+    opacity: bound && !active ? 0.82 : 1.0
+
+    // Rows are pooled and reused by the per-device ListView, so the bound session can change
+    // underneath us: resync the slider and drop any transient hover/wheel state.
+    onVolumeChanged: {
+        if (!slider.pressed && !root._wheelAdjusting)
+            slider.value = volume
+    }
+
+    function resetTransientState() {
+        iconHoverTimer.stop()
+        iconTip.close()
+        ctxMenu.close()
+        wheelSyncHold.stop()
+        root._wheelAdjusting = false
+    }
+
+    Component.onCompleted: if (appController) appController.noteSessionDelegateCreated()
+    Component.onDestruction: if (appController) appController.noteSessionDelegateDestroyed()
+    ListView.onPooled: resetTransientState()
+    ListView.onReused: {
+        slider.value = volume
+        if (appController) appController.noteSessionDelegateReused()
+    }
 
     // Unified hover state for the entire row (works even when hovering child controls like the slider/icon).
     HoverHandler {
@@ -64,8 +98,10 @@ Item {
                 anchors.centerIn: parent
                 width: 20
                 height: 20
+                // Asks the provider for a device-pixel-exact variant instead of scaling 64 px.
+                sourceSize: Qt.size(20, 20)
                 smooth: true
-                source: sessionObject && sessionObject.iconKey ? ("image://appicon/" + encodeURIComponent(sessionObject.iconKey)) : ""
+                source: iconKey ? ("image://appicon/" + encodeURIComponent(iconKey)) : ""
             }
 
             MouseArea {
@@ -75,7 +111,7 @@ Item {
                 cursorShape: Qt.PointingHandCursor
                 acceptedButtons: Qt.LeftButton | Qt.RightButton
                 onEntered: {
-                    if (appController && appController.showProcessStatusOnHover && sessionObject) {
+                    if (appController && appController.showProcessStatusOnHover && bound) {
                         iconHoverTimer.restart()
                     }
                 }
@@ -90,11 +126,11 @@ Item {
                     }
                 }
                 onClicked: function(mouse) {
-                    if (!sessionObject) return
+                    if (!bound) return
                     if (mouse.button === Qt.RightButton) {
                         ctxMenu.popup()
                     } else {
-                        sessionObject.toggleMute()
+                        sessions.toggleMute(row)
                     }
                 }
             }
@@ -104,16 +140,16 @@ Item {
                 StyledMenuItem {
                     text: "Hide globally"
                     onTriggered: {
-                        if (appController && sessionObject) {
-                            appController.setProcessHiddenGlobal(sessionObject.exePath, true)
+                        if (appController && bound) {
+                            appController.setProcessHiddenGlobal(exePath, true)
                         }
                     }
                 }
                 StyledMenuItem {
                     text: "Hide on this device"
                     onTriggered: {
-                        if (appController && sessionObject) {
-                            appController.setProcessHiddenForDevice(sessionObject.deviceId, sessionObject.exePath, true)
+                        if (appController && bound) {
+                            appController.setProcessHiddenForDevice(deviceId, exePath, true)
                         }
                     }
                 }
@@ -128,13 +164,13 @@ Item {
 
             font.family: theme.iconFont
             font.pixelSize: 14
-            text: sessionObject && sessionObject.muted ? theme.glyphMute : theme.glyphSpeaker
+            text: muted ? theme.glyphMute : theme.glyphSpeaker
 
             background: Rectangle {
                 radius: 8
                 color: muteBtn.hovered ? "#2E3136" : "transparent"
             }
-            onClicked: if (sessionObject) sessionObject.toggleMute()
+            onClicked: if (bound) sessions.toggleMute(row)
         }
 
         // Wrap slider + activity meter so the meter DOES NOT participate in RowLayout sizing
@@ -147,22 +183,11 @@ Item {
             Styles.SliderStyle {
                 id: slider
                 anchors.fill: parent
-                accentColor: (sessionObject && sessionObject.muted) ? "#6A6F78" : theme.accent
-                inactiveColor: (sessionObject && sessionObject.muted) ? "#3A3D44" : theme.trackInactive
-                onMoved: if (sessionObject) sessionObject.setVolume(value)
+                accentColor: muted ? "#6A6F78" : theme.accent
+                inactiveColor: muted ? "#3A3D44" : theme.trackInactive
+                onMoved: if (bound) sessions.setVolume(row, value)
 
-                Component.onCompleted: {
-                    if (sessionObject) slider.value = sessionObject.volume
-                }
-
-                Connections {
-                    target: sessionObject
-                    function onChanged() {
-                        if (!slider.pressed && !root._wheelAdjusting && sessionObject) {
-                            slider.value = sessionObject.volume
-                        }
-                    }
-                }
+                Component.onCompleted: slider.value = root.volume
             }
 
             Timer {
@@ -180,7 +205,7 @@ Item {
                 onWheel: function(ev) {
                     if (!enabled)
                         return
-                    if (!sessionObject || slider.pressed)
+                    if (!bound || slider.pressed)
                         return
 
                     var steps = 0
@@ -198,7 +223,7 @@ Item {
                     var next = slider.value + steps * 0.02
                     next = Math.max(0, Math.min(1, next))
                     slider.value = next
-                    sessionObject.setVolume(next)
+                    sessions.setVolume(row, next)
                     root._wheelAdjusting = true
                     wheelSyncHold.restart()
                     ev.accepted = true
@@ -251,7 +276,7 @@ Item {
         onTriggered: {
             if (!(appController && appController.showProcessStatusOnHover))
                 return
-            if (!sessionObject || !iconMouse.containsMouse)
+            if (!bound || !iconMouse.containsMouse)
                 return
             root.positionIconTipAtCursor()
             iconTip.open()
@@ -284,7 +309,7 @@ Item {
                 id: tipText
                 anchors.fill: parent
                 anchors.margins: 8
-                text: sessionObject ? sessionObject.displayName : ""
+                text: root.displayName
                 color: theme.text
                 font.pixelSize: 12
                 elide: Text.ElideRight
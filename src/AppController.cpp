@@ -1,8 +1,15 @@
 #include "AppController.h"
 
 #include "AudioBackend.h"
+#include "AudioDevice.h"
 #include "DeviceListModel.h"
+#include "DiagnosticsWindow.h"
+#include "HiddenItemsModels.h"
 #include "IconCache.h"
+#include "IconTextureFactory.h"
+#include "Metrics.h"
+#include "Tracer.h"
+#include "SessionListModel.h"
 #include "ConfigStore.h"
 #include "WinAcrylic.h"
 #include "WinTrayPositioner.h"
@@ -28,6 +35,8 @@
 #include <QSettings>
 #include <QUrl>
 #include <QDialog>
+#include <QInputDialog>
+#include <QLineEdit>
 #include <QLabel>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -40,7 +49,6 @@
 
 #include <windows.h>
 
-static QIcon makeEarieTrayIcon(double volume01, bool muted);
 static QString trayMenuStyleSheet();
 static void openWindowsVolumeMixer();
 static void openWindowsPlaybackDevices();
@@ -49,6 +57,8 @@ static void openWindowsSoundSettings();
 AppController::AppController(QObject *parent)
     : QObject(parent)
 {
+    m_startupClock.start();
+
     m_trayIconCoalesce.setSingleShot(true);
     m_trayIconCoalesce.setInterval(60);
     m_trayIconCoalesce.setParent(this);
@@ -59,12 +69,13 @@ AppController::AppController(QObject *parent)
         const bool muted = m_pendingTrayMuted;
         m_pendingTrayVolPct = -1;
 
-        if (pct == m_lastTrayVolPct && muted == m_lastTrayMuted)
-            return;
         m_lastTrayVolPct = pct;
+        const int level = m_trayIcons.levelFor(pct / 100.0);
+        if (level == m_lastTrayLevel && muted == m_lastTrayMuted)
+            return;
+        m_lastTrayLevel = level;
         m_lastTrayMuted = muted;
-
-        m_tray.setIcon(makeEarieTrayIcon(pct / 100.0, muted));
+        applyTrayIcon(level, muted);
     });
 
     m_trayToggleSuppressTimer.setSingleShot(true);
@@ -83,6 +94,26 @@ AppController::AppController(QObject *parent)
         adjustFlyoutHeightToContent();
         positionFlyout();
     });
+
+    m_hiddenLayoutCoalesce.setSingleShot(true);
+    m_hiddenLayoutCoalesce.setInterval(50);
+    m_hiddenLayoutCoalesce.setParent(this);
+    connect(&m_hiddenLayoutCoalesce, &QTimer::timeout, this, [this]() {
+        // Visible flyouts are handled by requestRelayout(); this path only pre-lays out hidden ones.
+        if (!m_view || (m_view->isVisible() && !m_prewarming.load()))
+            return;
+        layoutHiddenFlyout();
+    });
+
+    m_hiddenItemsRefresh.setSingleShot(true);
+    m_hiddenItemsRefresh.setInterval(0);
+    m_hiddenItemsRefresh.setParent(this);
+    connect(&m_hiddenItemsRefresh, &QTimer::timeout, this, &AppController::refreshHiddenItemsModels);
+    connect(this, &AppController::hiddenItemsChanged, this, &AppController::scheduleHiddenItemsRefresh);
+
+    m_hiddenDevicesModel = new HiddenDeviceListModel(this);
+    m_hiddenProcessesGlobalModel = new HiddenProcessListModel(this);
+    m_hiddenProcessesPerDeviceModel = new HiddenPerDeviceListModel(this);
 }
 
 AppController::~AppController()
@@ -93,6 +124,7 @@ AppController::~AppController()
     if (m_hiddenView) {
         m_hiddenView->removeEventFilter(this);
     }
+    delete m_diagnostics;
 }
 
 bool AppController::init()
@@ -108,6 +140,7 @@ bool AppController::init()
     m_showProcessStatusOnHover = m_config->showProcessStatusOnHover();
     m_scrollWheelVolumeOnHover = m_config->scrollWheelVolumeOnHover();
     m_startWithWindows = m_config->startWithWindows();
+    m_trayIcons.setStyle(TrayIconRenderer::styleFromString(m_config->trayIconStyle()));
     applyStartWithWindows(m_startWithWindows);
 
     m_audio = new AudioBackend(this);
@@ -115,6 +148,7 @@ bool AppController::init()
     m_audio->setAllDevices(m_allDevices);
     m_audio->setShowSystemSessions(m_showSystemSessions);
     m_audio->start();
+    registerMetricSources();
 
     buildFlyout();
     buildTray();
@@ -127,6 +161,14 @@ bool AppController::init()
     connect(m_audio, &AudioBackend::knownProcessesChanged, this, &AppController::rebuildHiddenMenus);
     connect(m_audio, &AudioBackend::devicesChanged, this, [this]() { emit hiddenItemsChanged(); });
     connect(m_audio, &AudioBackend::knownProcessesChanged, this, [this]() { emit hiddenItemsChanged(); });
+    connect(m_audio, &AudioBackend::knownProcessesChanged, this, [this]() {
+        if (m_view && !m_view->isVisible())
+            scheduleHiddenFlyoutLayout();
+    });
+    // Connected after AudioBackend::setConfig(), so the backend has re-filtered by the time this runs.
+    connect(m_config, &ConfigStore::changesCommitted, this, &AppController::onConfigChanged);
+
+    QTimer::singleShot(0, this, &AppController::prewarmFlyout);
 
     // If the user clicks the desktop while a QML menu is open, the flyout is already deactivated
     // (because the menu is its own native window), so WindowDeactivate won't fire again.
@@ -134,7 +176,7 @@ bool AppController::init()
     connect(qApp, &QGuiApplication::applicationStateChanged, this, [this](Qt::ApplicationState state) {
         if (state == Qt::ApplicationActive)
             return;
-        const bool flyoutVisible = m_view && m_view->isVisible();
+        const bool flyoutVisible = m_view && m_view->isVisible() && !m_prewarming.load();
         const bool hiddenVisible = m_hiddenView && m_hiddenView->isVisible();
         if (!flyoutVisible && !hiddenVisible)
             return;
@@ -188,9 +230,9 @@ QRect AppController::cursorScreenAvailableGeometry() const
     return s ? s->availableGeometry() : QRect(0, 0, 1920, 1080);
 }
 
-QVariantList AppController::hiddenDevicesSnapshot() const
+QVector<HiddenDeviceEntry> AppController::hiddenDeviceEntries() const
 {
-    QVariantList out;
+    QVector<HiddenDeviceEntry> out;
     if (!m_audio || !m_config)
         return out;
 
@@ -200,30 +242,30 @@ QVariantList AppController::hiddenDevicesSnapshot() const
         if (d.id.isEmpty())
             continue;
         seen.insert(d.id);
-        QVariantMap m;
-        m.insert(QStringLiteral("deviceId"), d.id);
-        m.insert(QStringLiteral("name"), d.name.isEmpty() ? d.id : d.name);
-        m.insert(QStringLiteral("connected"), true);
-        m.insert(QStringLiteral("hidden"), m_config->isDeviceHidden(d.id));
-        out.append(m);
+        HiddenDeviceEntry e;
+        e.deviceId = d.id;
+        e.name = d.name.isEmpty() ? d.id : d.name;
+        e.connected = true;
+        e.hidden = m_config->isDeviceHidden(d.id);
+        out.append(e);
     }
 
     for (const auto &hiddenId : m_config->hiddenDevices()) {
         if (hiddenId.isEmpty() || seen.contains(hiddenId))
             continue;
-        QVariantMap m;
-        m.insert(QStringLiteral("deviceId"), hiddenId);
-        m.insert(QStringLiteral("name"), hiddenId);
-        m.insert(QStringLiteral("connected"), false);
-        m.insert(QStringLiteral("hidden"), true);
-        out.append(m);
+        HiddenDeviceEntry e;
+        e.deviceId = hiddenId;
+        e.name = hiddenId;
+        e.connected = false;
+        e.hidden = true;
+        out.append(e);
     }
     return out;
 }
 
-QVariantList AppController::hiddenProcessesGlobalSnapshot() const
+QVector<HiddenProcessEntry> AppController::hiddenProcessGlobalEntries() const
 {
-    QVariantList out;
+    QVector<HiddenProcessEntry> out;
     if (!m_audio || !m_config)
         return out;
 
@@ -255,23 +297,48 @@ QVariantList AppController::hiddenProcessesGlobalSnapshot() const
         return an < bn;
     });
 
+    out.reserve(exes.size());
     for (const auto &exe : exes) {
-        const QString label = nameByExe.value(exe).isEmpty() ? exe : nameByExe.value(exe);
-        QVariantMap m;
-        m.insert(QStringLiteral("exePath"), exe);
-        m.insert(QStringLiteral("name"), label);
-        m.insert(QStringLiteral("hidden"), m_config->isProcessHiddenGlobal(exe));
-        out.append(m);
+        HiddenProcessEntry e;
+        e.exePath = exe;
+        e.name = nameByExe.value(exe).isEmpty() ? exe : nameByExe.value(exe);
+        e.hidden = m_config->isProcessHiddenGlobal(exe);
+        out.append(e);
     }
     return out;
 }
 
-QVariantList AppController::hiddenProcessesPerDeviceSnapshot() const
+QVector<HiddenDeviceProcessesEntry> AppController::hiddenProcessPerDeviceEntries() const
 {
-    QVariantList out;
+    QVector<HiddenDeviceProcessesEntry> out;
     if (!m_audio || !m_config)
         return out;
 
+    auto sortedEntries = [this](const QString &devId, const QHash<QString, QString> &perNameByExe) {
+        QVector<QString> exes;
+        exes.reserve(perNameByExe.size());
+        for (auto it = perNameByExe.begin(); it != perNameByExe.end(); ++it)
+            exes.push_back(it.key());
+        std::sort(exes.begin(), exes.end(), [&perNameByExe](const QString &a, const QString &b) {
+            const QString an = perNameByExe.value(a).toCaseFolded();
+            const QString bn = perNameByExe.value(b).toCaseFolded();
+            if (an == bn)
+                return a.toCaseFolded() < b.toCaseFolded();
+            return an < bn;
+        });
+
+        QVector<HiddenProcessEntry> procs;
+        procs.reserve(exes.size());
+        for (const auto &exe : exes) {
+            HiddenProcessEntry p;
+            p.exePath = exe;
+            p.name = perNameByExe.value(exe).isEmpty() ? exe : perNameByExe.value(exe);
+            p.hidden = m_config->isProcessHiddenForDevice(devId, exe);
+            procs.append(p);
+        }
+        return procs;
+    };
+
     const auto devicesAll = m_audio->devicesSnapshotAll();
     QSet<QString> visibleDevIds;
     for (const auto &d : devicesAll)
@@ -300,33 +367,11 @@ QVariantList AppController::hiddenProcessesPerDeviceSnapshot() const
             }
         }
 
-        QVector<QString> exes;
-        exes.reserve(perNameByExe.size());
-        for (auto it = perNameByExe.begin(); it != perNameByExe.end(); ++it)
-            exes.push_back(it.key());
-        std::sort(exes.begin(), exes.end(), [&perNameByExe](const QString &a, const QString &b) {
-            const QString an = perNameByExe.value(a).toCaseFolded();
-            const QString bn = perNameByExe.value(b).toCaseFolded();
-            if (an == bn)
-                return a.toCaseFolded() < b.toCaseFolded();
-            return an < bn;
-        });
-
-        QVariantList procList;
-        for (const auto &exe : exes) {
-            const QString label = perNameByExe.value(exe).isEmpty() ? exe : perNameByExe.value(exe);
-            QVariantMap p;
-            p.insert(QStringLiteral("exePath"), exe);
-            p.insert(QStringLiteral("name"), label);
-            p.insert(QStringLiteral("hidden"), m_config->isProcessHiddenForDevice(d.id, exe));
-            procList.append(p);
-        }
-
-        QVariantMap dev;
-        dev.insert(QStringLiteral("deviceId"), d.id);
-        dev.insert(QStringLiteral("name"), d.name.isEmpty() ? d.id : d.name);
-        dev.insert(QStringLiteral("connected"), true);
-        dev.insert(QStringLiteral("processes"), procList);
+        HiddenDeviceProcessesEntry dev;
+        dev.deviceId = d.id;
+        dev.name = d.name.isEmpty() ? d.id : d.name;
+        dev.connected = true;
+        dev.processes = sortedEntries(d.id, perNameByExe);
         out.append(dev);
     }
 
@@ -348,39 +393,47 @@ QVariantList AppController::hiddenProcessesPerDeviceSnapshot() const
             perNameByExe.insert(exe, base.isEmpty() ? exe : base);
         }
 
-        QVector<QString> exes;
-        exes.reserve(perNameByExe.size());
-        for (auto it2 = perNameByExe.begin(); it2 != perNameByExe.end(); ++it2)
-            exes.push_back(it2.key());
-        std::sort(exes.begin(), exes.end(), [&perNameByExe](const QString &a, const QString &b) {
-            const QString an = perNameByExe.value(a).toCaseFolded();
-            const QString bn = perNameByExe.value(b).toCaseFolded();
-            if (an == bn)
-                return a.toCaseFolded() < b.toCaseFolded();
-            return an < bn;
-        });
-
-        QVariantList procList;
-        for (const auto &exe : exes) {
-            const QString label = perNameByExe.value(exe).isEmpty() ? exe : perNameByExe.value(exe);
-            QVariantMap p;
-            p.insert(QStringLiteral("exePath"), exe);
-            p.insert(QStringLiteral("name"), label);
-            p.insert(QStringLiteral("hidden"), m_config->isProcessHiddenForDevice(devId, exe));
-            procList.append(p);
-        }
-
-        QVariantMap dev;
-        dev.insert(QStringLiteral("deviceId"), devId);
-        dev.insert(QStringLiteral("name"), devId);
-        dev.insert(QStringLiteral("connected"), false);
-        dev.insert(QStringLiteral("processes"), procList);
+        HiddenDeviceProcessesEntry dev;
+        dev.deviceId = devId;
+        dev.name = devId;
+        dev.connected = false;
+        dev.processes = sortedEntries(devId, perNameByExe);
         out.append(dev);
     }
 
     return out;
 }
 
+void AppController::scheduleHiddenItemsRefresh()
+{
+    // Several sources fire hiddenItemsChanged for one user action; diff once per event-loop turn.
+    m_hiddenItemsDirty = true;
+    if (!m_hiddenItemsRefresh.isActive())
+        m_hiddenItemsRefresh.start();
+}
+
+void AppController::refreshHiddenItemsModels()
+{
+    // Only keep the models current while the window is up; showHiddenItemsWindow() catches up.
+    if (!m_hiddenView || !m_hiddenView->isVisible())
+        return;
+    syncHiddenItemsModels();
+}
+
+void AppController::syncHiddenItemsModels()
+{
+    if (!m_hiddenItemsDirty)
+        return;
+    m_hiddenItemsDirty = false;
+
+    if (m_hiddenDevicesModel)
+        m_hiddenDevicesModel->sync(hiddenDeviceEntries());
+    if (m_hiddenProcessesGlobalModel)
+        m_hiddenProcessesGlobalModel->sync(hiddenProcessGlobalEntries());
+    if (m_hiddenProcessesPerDeviceModel)
+        m_hiddenProcessesPerDeviceModel->sync(hiddenProcessPerDeviceEntries());
+}
+
 void AppController::popupOpened()
 {
     m_popupDepth = qMax(0, m_popupDepth + 1);
@@ -395,6 +448,61 @@ void AppController::popupClosed()
     }
 }
 
+void AppController::noteSessionDelegateCreated()
+{
+    ++m_sessionDelegatesCreated;
+    ++m_sessionDelegatesAlive;
+    emit sessionDelegateStatsChanged();
+}
+
+void AppController::noteSessionDelegateDestroyed()
+{
+    m_sessionDelegatesAlive = qMax(0, m_sessionDelegatesAlive - 1);
+    emit sessionDelegateStatsChanged();
+}
+
+void AppController::noteSessionDelegateReused()
+{
+    ++m_sessionDelegatesReused;
+    emit sessionDelegateStatsChanged();
+}
+
+QVariantMap AppController::iconStats() const
+{
+    QVariantMap out = m_audio && m_audio->iconCache() ? m_audio->iconCache()->stats() : QVariantMap();
+
+    int sessionsShown = 0;
+    if (m_audio && m_audio->deviceModel()) {
+        const auto devices = m_audio->deviceModel()->devices();
+        for (auto *d : devices) {
+            if (d)
+                sessionsShown += d->sessionsModelTyped()->rowCount();
+        }
+    }
+    out.insert(QStringLiteral("sessionsShown"), sessionsShown);
+    out.insert(QStringLiteral("firstPaintMissesLast"), m_lastFirstPaintIconMisses);
+    out.insert(QStringLiteral("firstPaintMissesTotal"), m_totalFirstPaintIconMisses);
+    out.insert(QStringLiteral("flyoutOpens"), m_flyoutOpenLatency.count());
+    out.insert(QStringLiteral("trayIconSets"), m_trayIconSets);
+    out.insert(QStringLiteral("trayIconStates"), m_trayIcons.cachedStates());
+
+    const QVariantMap tex = IconTextureFactory::stats();
+    for (auto it = tex.constBegin(); it != tex.constEnd(); ++it)
+        out.insert(it.key(), it.value());
+    return out;
+}
+
+QVariantMap AppController::startupStats() const
+{
+    QVariantMap out = m_audio ? m_audio->startupStats() : QVariantMap();
+    const qint64 ns = m_firstUsefulPaintNs.load();
+    out.insert(QStringLiteral("firstUsefulPaintMs"), ns < 0 ? -1.0 : ns / 1e6);
+    out.insert(QStringLiteral("firstUsefulPaintFromWarmStart"), ns >= 0 && m_deviceRowsFromWarmStart);
+    const qint64 prewarmNs = m_prewarmPaintNs.load();
+    out.insert(QStringLiteral("prewarmPaintMs"), prewarmNs < 0 ? -1.0 : prewarmNs / 1e6);
+    return out;
+}
+
 void AppController::setShowSystemSessions(bool v)
 {
     if (m_showSystemSessions == v)
@@ -427,6 +535,41 @@ void AppController::setScrollWheelVolumeOnHover(bool v)
     emit scrollWheelVolumeOnHoverChanged();
 }
 
+void AppController::setTrayIconStyle(const QString &style)
+{
+    const auto s = TrayIconRenderer::styleFromString(style);
+    if (m_trayIcons.style() == s)
+        return;
+    m_trayIcons.setStyle(s);
+    if (m_config)
+        m_config->setTrayIconStyle(TrayIconRenderer::styleToString(s));
+    rebuildTrayIcons();
+    emit trayIconStyleChanged();
+}
+
+bool AppController::rememberAppVolumes() const
+{
+    return m_config ? m_config->rememberAppVolumes() : true;
+}
+
+void AppController::setRememberAppVolumes(bool v)
+{
+    // ConfigStore is the single source of truth; the NOTIFY comes back through onConfigChanged.
+    if (m_config)
+        m_config->setRememberAppVolumes(v);
+}
+
+bool AppController::rememberAppVolumesPerDevice() const
+{
+    return m_config && m_config->rememberAppVolumesPerDevice();
+}
+
+void AppController::setRememberAppVolumesPerDevice(bool v)
+{
+    if (m_config)
+        m_config->setRememberAppVolumesPerDevice(v);
+}
+
 void AppController::setStartWithWindows(bool v)
 {
     if (m_startWithWindows == v)
@@ -441,6 +584,8 @@ void AppController::toggleFlyout()
 {
     if (!m_view)
         return;
+    if (m_prewarming.load())
+        finishPrewarm();
     if (m_view->isVisible())
         hideFlyout();
     else
@@ -452,11 +597,6 @@ void AppController::setDeviceHidden(const QString &deviceId, bool hidden)
     if (!m_config || deviceId.isEmpty())
         return;
     m_config->setDeviceHidden(deviceId, hidden);
-    if (m_audio)
-        m_audio->refresh();
-    rebuildHiddenMenus();
-    requestRelayout();
-    emit hiddenItemsChanged();
 }
 
 void AppController::setProcessHiddenGlobal(const QString &exePath, bool hidden)
@@ -464,11 +604,6 @@ void AppController::setProcessHiddenGlobal(const QString &exePath, bool hidden)
     if (!m_config || exePath.isEmpty())
         return;
     m_config->setProcessHiddenGlobal(exePath, hidden);
-    if (m_audio)
-        m_audio->refresh();
-    rebuildHiddenMenus();
-    requestRelayout();
-    emit hiddenItemsChanged();
 }
 
 void AppController::setProcessHiddenForDevice(const QString &deviceId, const QString &exePath, bool hidden)
@@ -476,8 +611,52 @@ void AppController::setProcessHiddenForDevice(const QString &deviceId, const QSt
     if (!m_config || deviceId.isEmpty() || exePath.isEmpty())
         return;
     m_config->setProcessHiddenForDevice(deviceId, exePath, hidden);
-    if (m_audio)
-        m_audio->refresh();
+}
+
+void AppController::unhideAll()
+{
+    if (!m_config)
+        return;
+    // One notification (one backend re-filter, one menu rebuild, one save) for the whole sweep.
+    ConfigStore::Batch batch(m_config);
+    for (const auto &id : m_config->hiddenDevices())
+        m_config->setDeviceHidden(id, false);
+    const QSet<QString> global = m_config->hiddenProcessesGlobalSet();
+    for (const auto &exe : global)
+        m_config->setProcessHiddenGlobal(exe, false);
+    const auto perDevice = m_config->hiddenProcessesPerDeviceMap();
+    for (auto it = perDevice.cbegin(); it != perDevice.cend(); ++it) {
+        for (const auto &exe : it.value())
+            m_config->setProcessHiddenForDevice(it.key(), exe, false);
+    }
+}
+
+void AppController::onConfigChanged(const ConfigStore::ChangeSet &changes)
+{
+    using CS = ConfigStore::ChangeSet;
+
+    // Our own setters already hold the new value (no-ops here); this picks up edits made to
+    // config.json from outside.
+    if (changes.has(CS::ModeField))
+        setAllDevices(m_config->mode() == ConfigStore::Mode::AllDevices);
+    if (changes.has(CS::ShowSystemSessionsField))
+        setShowSystemSessions(m_config->showSystemSessions());
+    if (changes.has(CS::ShowProcessStatusOnHoverField))
+        setShowProcessStatusOnHover(m_config->showProcessStatusOnHover());
+    if (changes.has(CS::ScrollWheelVolumeOnHoverField))
+        setScrollWheelVolumeOnHover(m_config->scrollWheelVolumeOnHover());
+    if (changes.has(CS::StartWithWindowsField)) {
+        setStartWithWindows(m_config->startWithWindows());
+        if (m_actionStartWithWindows)
+            m_actionStartWithWindows->setChecked(m_startWithWindows);
+    }
+    if (changes.has(CS::TrayIconStyleField))
+        setTrayIconStyle(m_config->trayIconStyle());
+    if (changes.has(CS::RememberAppVolumesField))
+        emit rememberAppVolumesChanged();
+
+    if (!changes.has(CS::HiddenRulesFields))
+        return;
     rebuildHiddenMenus();
     requestRelayout();
     emit hiddenItemsChanged();
@@ -485,8 +664,12 @@ void AppController::setProcessHiddenForDevice(const QString &deviceId, const QSt
 
 void AppController::requestRelayout()
 {
-    if (!m_view || !m_view->isVisible())
+    if (!m_view)
+        return;
+    if (!m_view->isVisible()) {
+        scheduleHiddenFlyoutLayout();
         return;
+    }
     if (!m_relayoutCoalesce.isActive())
         m_relayoutCoalesce.start();
     // A second measure pass after delegates settle (covers animated row removal, etc).
@@ -502,8 +685,26 @@ void AppController::showFlyout()
 {
     if (!m_view)
         return;
-    adjustFlyoutHeightToContent();
-    positionFlyout();
+    if (m_prewarming.load())
+        finishPrewarm();
+    // Changes applied while hidden were never on screen; do not time them against this open.
+    if (m_audio)
+        m_audio->takeAppliedChangeStamps();
+
+    // Latency sample runs from the tray click (or from here for menu/QML opens) to the first
+    // frame the flyout presents; see the frameSwapped hook in buildFlyout().
+    if (!m_flyoutClickPending)
+        m_flyoutOpenClock.start();
+    m_flyoutClickPending = false;
+
+    // Usually already laid out while hidden; only the position can be stale (tray/screen moved).
+    const bool wasDirty = m_flyoutLayoutDirty;
+    if (wasDirty)
+        layoutHiddenFlyout();
+    else
+        positionFlyout();
+
+    m_awaitingFlyoutFrame.store(true);
     m_view->show();
     m_view->requestActivate();
 
@@ -514,12 +715,83 @@ void AppController::showFlyout()
         adjustFlyoutHeightToContent();
         positionFlyout();
     });
-    QTimer::singleShot(50, this, [this]() {
-        if (!m_view || !m_view->isVisible())
-            return;
-        adjustFlyoutHeightToContent();
+    if (wasDirty) {
+        QTimer::singleShot(50, this, [this]() {
+            if (!m_view || !m_view->isVisible())
+                return;
+            adjustFlyoutHeightToContent();
+            positionFlyout();
+        });
+    }
+}
+
+void AppController::prewarmFlyout()
+{
+    if (!m_view || m_view->isVisible())
+        return;
+
+    // Present one invisible frame off-screen at startup so the first real open finds the render
+    // loop, swapchain, pipelines and glyph caches initialized (kept alive by persistent graphics).
+    m_prewarming.store(true);
+    layoutHiddenFlyout();
+    // Showing a focusable Qt::Tool window activates it; the prewarm frame must not take focus
+    // from whatever the user is doing at login.
+    m_view->setFlag(Qt::WindowDoesNotAcceptFocus, true);
+    m_view->setOpacity(0.0);
+    m_view->setPosition(QPoint(-32000, -32000));
+    m_view->show();
+}
+
+void AppController::finishPrewarm()
+{
+    if (!m_prewarming.exchange(false))
+        return;
+    if (m_view) {
+        m_view->hide();
+        m_view->setFlag(Qt::WindowDoesNotAcceptFocus, false);
+        m_view->setOpacity(1.0);
         positionFlyout();
-    });
+    }
+}
+
+int AppController::placeholderIconRows() const
+{
+    if (!m_audio || !m_audio->deviceModel())
+        return 0;
+    int n = 0;
+    const QString placeholder = IconCache::placeholderKey();
+    const auto devices = m_audio->deviceModel()->devices();
+    for (auto *d : devices) {
+        if (d)
+            n += d->sessionsModelTyped()->countIconKey(placeholder);
+    }
+    return n;
+}
+
+void AppController::noteFirstPaintIconMisses()
+{
+    // With prefetch driven by the worker's executableSeen this should stay at zero.
+    m_lastFirstPaintIconMisses = placeholderIconRows();
+    m_totalFirstPaintIconMisses += quint64(m_lastFirstPaintIconMisses);
+}
+
+void AppController::scheduleHiddenFlyoutLayout()
+{
+    m_flyoutLayoutDirty = true;
+    if (!m_hiddenLayoutCoalesce.isActive())
+        m_hiddenLayoutCoalesce.start();
+}
+
+void AppController::layoutHiddenFlyout()
+{
+    if (!m_view)
+        return;
+    // Force QML list layout synchronously (a hidden window never polishes on its own).
+    if (QObject *root = m_view->rootObject())
+        QMetaObject::invokeMethod(root, "prewarmLayout");
+    adjustFlyoutHeightToContent();
+    positionFlyout();
+    m_flyoutLayoutDirty = false;
 }
 
 void AppController::hideFlyout()
@@ -536,6 +808,8 @@ void AppController::showHiddenItemsWindow()
     if (!m_hiddenView)
         return;
 
+    m_hiddenItemsDirty = true;
+    syncHiddenItemsModels();
     adjustHiddenItemsHeightToContent();
     positionHiddenItemsWindow(true);
     m_hiddenView->show();
@@ -576,6 +850,52 @@ void AppController::hideHiddenItemsWindow()
     m_hiddenView->hide();
 }
 
+void AppController::showDiagnosticsWindow()
+{
+    if (!m_diagnostics)
+        m_diagnostics = new DiagnosticsWindow;
+    m_diagnostics->show();
+    m_diagnostics->raise();
+    m_diagnostics->activateWindow();
+}
+
+QVariantMap AppController::changeLatency() const
+{
+    auto &metrics = Metrics::instance();
+    QVariantMap out;
+    out.insert(QStringLiteral("externalToApply"), metrics.histogram(QStringLiteral("latency.externalToApply")).toVariantMap());
+    out.insert(QStringLiteral("externalToDisplay"), metrics.histogram(QStringLiteral("latency.externalToDisplay")).toVariantMap());
+    out.insert(QStringLiteral("sliderToComWrite"), metrics.histogram(QStringLiteral("latency.sliderToComWrite")).toVariantMap());
+    return out;
+}
+
+void AppController::registerMetricSources()
+{
+    auto &metrics = Metrics::instance();
+    metrics.addSource(QStringLiteral("flyoutOpenLatency"), this, [this]() { return flyoutOpenLatency(); });
+    metrics.addSource(QStringLiteral("icons"), this, [this]() { return iconStats(); });
+    metrics.addSource(QStringLiteral("sessionDelegates"), this, [this]() {
+        QVariantMap out;
+        out.insert(QStringLiteral("created"), m_sessionDelegatesCreated);
+        out.insert(QStringLiteral("alive"), m_sessionDelegatesAlive);
+        out.insert(QStringLiteral("reused"), m_sessionDelegatesReused);
+        return out;
+    });
+    metrics.addSource(QStringLiteral("startup"), this, [this]() { return startupStats(); });
+    if (m_config)
+        metrics.addSource(QStringLiteral("config"), m_config, [cfg = m_config]() { return cfg->saveStats(); });
+    metrics.addSource(QStringLiteral("changeLatency"), this, [this]() { return changeLatency(); });
+    if (m_audio) {
+        metrics.addSource(QStringLiteral("hiddenRules"), m_audio, [audio = m_audio]() { return audio->hiddenRuleStats(); });
+        metrics.addSource(QStringLiteral("scenes"), m_audio, [audio = m_audio]() { return audio->sceneStats(); });
+        metrics.addSource(QStringLiteral("audioErrors"), m_audio, [audio = m_audio]() {
+            QVariantMap out;
+            out.insert(QStringLiteral("recent"), audio->recentErrors());
+            return out;
+        });
+    }
+}
+
 void AppController::showAboutDialog()
 {
     QDialog dialog;
@@ -621,6 +941,96 @@ void AppController::showAboutDialog()
     dialog.exec();
 }
 
+QStringList AppController::sceneNames() const
+{
+    QStringList out;
+    if (!m_config)
+        return out;
+    for (const auto &scene : m_config->scenes())
+        out.append(scene.name);
+    return out;
+}
+
+void AppController::saveScene(const QString &name)
+{
+    const QString trimmed = name.trimmed();
+    if (!m_audio || !m_config || trimmed.isEmpty())
+        return;
+    m_config->saveScene(m_audio->captureScene(trimmed));
+}
+
+void AppController::applyScene(const QString &name)
+{
+    if (!m_audio || !m_config)
+        return;
+    for (const auto &scene : m_config->scenes()) {
+        if (scene.name == name) {
+            m_audio->applyScene(scene);
+            return;
+        }
+    }
+}
+
+void AppController::removeScene(const QString &name)
+{
+    if (m_config)
+        m_config->removeScene(name);
+}
+
+QVariantMap AppController::sceneStats() const
+{
+    return m_audio ? m_audio->sceneStats() : QVariantMap();
+}
+
+void AppController::measureSceneApply(int targetCount, int runs)
+{
+    if (m_audio)
+        m_audio->measureSceneApply(targetCount, runs);
+}
+
+void AppController::rebuildScenesMenu()
+{
+    if (!m_scenesMenu || !m_config)
+        return;
+    m_scenesMenu->clear();
+
+    const auto &scenes = m_config->scenes();
+    if (scenes.isEmpty()) {
+        QAction *a = m_scenesMenu->addAction(tr("(No scenes)"));
+        a->setEnabled(false);
+    }
+    for (const auto &scene : scenes) {
+        const QString name = scene.name;
+        QAction *a = m_scenesMenu->addAction(name);
+        connect(a, &QAction::triggered, this, [this, name]() { applyScene(name); });
+    }
+
+    m_scenesMenu->addSeparator();
+    QAction *aSave = m_scenesMenu->addAction(tr("Save current levels as scene…"));
+    connect(aSave, &QAction::triggered, this, &AppController::promptSaveScene);
+
+    if (scenes.isEmpty())
+        return;
+    QMenu *removeMenu = m_scenesMenu->addMenu(tr("Delete scene"));
+    for (const auto &scene : scenes) {
+        const QString name = scene.name;
+        QAction *a = removeMenu->addAction(name);
+        connect(a, &QAction::triggered, this, [this, name]() { removeScene(name); });
+    }
+}
+
+void AppController::promptSaveScene()
+{
+    if (!m_config)
+        return;
+    bool ok = false;
+    const QString name = QInputDialog::getText(nullptr, tr("Save scene"),
+                                               tr("Scene name (an existing name is overwritten):"),
+                                               QLineEdit::Normal, tr("Scene %1").arg(m_config->scenes().size() + 1), &ok);
+    if (ok)
+        saveScene(name);
+}
+
 void AppController::buildFlyout()
 {
     m_view = new QQuickView;
@@ -648,12 +1058,58 @@ void AppController::buildFlyout()
 
     applyWindowEffectsIfPossible(m_view);
 
+    // Keep GPU resources and the scene graph alive across hide()/show() so reopening does not
+    // rebuild them from scratch.
+    m_view->setPersistentGraphics(true);
+    m_view->setPersistentSceneGraph(true);
+
+    connect(m_view, &QQuickWindow::beforeSynchronizing, this, [this]() {
+        // Render thread, GUI thread blocked for the sync: safe to take GUI-owned state. The
+        // stamps collected here are the changes the frame being prepared shows.
+        if (!m_audio)
+            return;
+        QVector<qint64> stamps = m_audio->takeAppliedChangeStamps();
+        if (!m_prewarming.load())
+            m_frameChangeStamps += stamps;
+    }, Qt::DirectConnection);
+
+    connect(m_view, &QQuickWindow::frameSwapped, this, [this]() {
+        // Runs on the render thread with the threaded loop: atomics + histogram only.
+        Tracer::setThreadName("qsg-render");
+        Tracer::Span span("qml.frameSwapped");
+        Tracer::flowEnd(Tracer::takeFrameFlow());
+        if (!m_frameChangeStamps.isEmpty()) {
+            static auto &toDisplay = Metrics::instance().histogram(QStringLiteral("latency.externalToDisplay"));
+            const qint64 now = Metrics::nowNs();
+            for (const qint64 stamp : std::as_const(m_frameChangeStamps))
+                toDisplay.record(now - stamp);
+            m_frameChangeStamps.clear();
+        }
+        if (m_prewarming.load()) {
+            // Drawn off-screen at opacity 0: warms the pipeline but shows the user nothing.
+            if (m_prewarmPaintNs.load() < 0)
+                m_prewarmPaintNs.store(m_startupClock.nsecsElapsed());
+            QMetaObject::invokeMethod(this, &AppController::finishPrewarm, Qt::QueuedConnection);
+            return;
+        }
+        if (m_firstUsefulPaintNs.load() < 0 && m_hasDeviceRows.load())
+            m_firstUsefulPaintNs.store(m_startupClock.nsecsElapsed());
+        if (m_awaitingFlyoutFrame.exchange(false)) {
+            m_flyoutOpenLatency.record(m_flyoutOpenClock.nsecsElapsed());
+            QMetaObject::invokeMethod(this, &AppController::noteFirstPaintIconMisses, Qt::QueuedConnection);
+        }
+    }, Qt::DirectConnection);
+
     // Auto-resize while visible when switching modes / devices list changes.
     if (m_audio && m_audio->deviceModel()) {
         auto *model = static_cast<QAbstractItemModel *>(m_audio->deviceModel());
         auto relayout = [this]() {
-            if (!m_view || !m_view->isVisible())
+            if (!m_view)
+                return;
+            if (!m_view->isVisible()) {
+                scheduleHiddenFlyoutLayout();
                 return;
+            }
             // Layout/contentHeight may settle after a tick; measure twice.
             QTimer::singleShot(0, this, [this]() {
                 if (!m_view || !m_view->isVisible())
@@ -672,6 +1128,18 @@ void AppController::buildFlyout()
         connect(model, &QAbstractItemModel::rowsRemoved, this, relayout);
         connect(model, &QAbstractItemModel::modelReset, this, relayout);
         connect(model, &QAbstractItemModel::layoutChanged, this, relayout);
+
+        // Warm start may already have populated the model before the view existed.
+        auto noteRows = [this, model]() {
+            const bool has = model->rowCount() > 0;
+            if (has && !m_hasDeviceRows.load())
+                m_deviceRowsFromWarmStart = m_audio && m_audio->isStale();
+            m_hasDeviceRows.store(has);
+        };
+        noteRows();
+        connect(model, &QAbstractItemModel::rowsInserted, this, noteRows);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, noteRows);
+        connect(model, &QAbstractItemModel::modelReset, this, noteRows);
     }
 }
 
@@ -687,6 +1155,12 @@ void AppController::buildHiddenItemsWindow()
     m_hiddenView->installEventFilter(this);
 
     m_hiddenView->rootContext()->setContextProperty(QStringLiteral("appController"), this);
+    m_hiddenView->rootContext()->setContextProperty(QStringLiteral("hiddenDevicesModel"),
+                                                    static_cast<QObject *>(m_hiddenDevicesModel));
+    m_hiddenView->rootContext()->setContextProperty(QStringLiteral("hiddenProcessesGlobalModel"),
+                                                    static_cast<QObject *>(m_hiddenProcessesGlobalModel));
+    m_hiddenView->rootContext()->setContextProperty(QStringLiteral("hiddenProcessesPerDeviceModel"),
+                                                    static_cast<QObject *>(m_hiddenProcessesPerDeviceModel));
     m_hiddenView->setSource(QUrl(QStringLiteral("qrc:/qml/HiddenItemsWindow.qml")));
     m_hiddenView->setWidth(420);
     m_hiddenView->setHeight(520);
@@ -852,11 +1326,20 @@ void AppController::buildTray()
 
     m_menu->addSeparator();
 
+    // Filled on every show, so it always lists the current scenes without rebuilding an open menu.
+    m_scenesMenu = m_menu->addMenu(tr("Scenes"));
+    connect(m_scenesMenu, &QMenu::aboutToShow, this, &AppController::rebuildScenesMenu);
+
+    m_menu->addSeparator();
+
     QAction *aHiddenItems = m_menu->addAction(tr("Manage hidden items…"));
     connect(aHiddenItems, &QAction::triggered, this, &AppController::showHiddenItemsWindow);
 
     m_menu->addSeparator();
 
+    QAction *aDiagnostics = m_menu->addAction(tr("Diagnostics…"));
+    connect(aDiagnostics, &QAction::triggered, this, &AppController::showDiagnosticsWindow);
+
     QAction *aAbout = m_menu->addAction(tr("About"));
     connect(aAbout, &QAction::triggered, this, &AppController::showAboutDialog);
 
@@ -866,10 +1349,27 @@ void AppController::buildTray()
 
     m_tray.setToolTip(QStringLiteral("Earie"));
     m_tray.setContextMenu(m_menu);
-    // Set a default icon before showing to avoid "No Icon set" warnings.
-    m_tray.setIcon(makeEarieTrayIcon(1.0, false));
+    // Rasterize every state up front and set a default icon before showing
+    // to avoid "No Icon set" warnings.
+    m_trayIcons.setTraySizes(TrayIconRenderer::traySizesForScreens());
+    m_trayIcons.prewarm();
+    m_lastTrayLevel = m_trayIcons.levelFor(1.0);
+    m_lastTrayMuted = false;
+    applyTrayIcon(m_lastTrayLevel, false);
     m_tray.show();
 
+    // Tray icon pixel size follows the DPI of the screens; re-rasterize when it changes.
+    const auto watchScreen = [this](QScreen *s) {
+        connect(s, &QScreen::logicalDotsPerInchChanged, this, &AppController::rebuildTrayIcons);
+    };
+    for (QScreen *s : QGuiApplication::screens())
+        watchScreen(s);
+    connect(qApp, &QGuiApplication::screenAdded, this, [this, watchScreen](QScreen *s) {
+        watchScreen(s);
+        rebuildTrayIcons();
+    });
+    connect(qApp, &QGuiApplication::screenRemoved, this, &AppController::rebuildTrayIcons);
+
     connect(&m_tray, &QSystemTrayIcon::activated, this, [this](QSystemTrayIcon::ActivationReason reason) {
         if (reason == QSystemTrayIcon::Trigger) {
             // If the flyout just closed due to WindowDeactivate (often triggered by this same click),
@@ -878,30 +1378,15 @@ void AppController::buildTray()
                 m_suppressNextTrayToggle = false;
                 return;
             }
+            if (m_view && (!m_view->isVisible() || m_prewarming.load())) {
+                m_flyoutOpenClock.start();
+                m_flyoutClickPending = true;
+            }
             toggleFlyout(); // left-click
         }
     });
 }
 
-static QIcon makeEarieTrayIcon(double volume01, bool muted)
-{
-    const double v = qBound(0.0, volume01, 1.0);
-    const int bars = muted
-        ? -1
-        : (v < 0.05 ? 0 : (v < 0.33 ? 1 : (v < 0.66 ? 2 : 3)));
-
-    const QString path = (bars < 0)
-        ? QStringLiteral(":/assets/vol_m.ico")
-        : QStringLiteral(":/assets/vol_%1.ico").arg(bars);
-
-    QIcon icon(path);
-    if (icon.isNull()) {
-        // Safety fallback (should not happen if resources are embedded)
-        icon = QIcon::fromTheme(QStringLiteral("audio-volume-high"));
-    }
-    return icon;
-}
-
 static QString trayMenuStyleSheet()
 {
     // Dark, rounded menu matching the app theme as closely as native tray menus allow.
@@ -993,6 +1478,26 @@ void AppController::updateTrayIcon()
         m_trayIconCoalesce.start();
 }
 
+void AppController::rebuildTrayIcons()
+{
+    m_trayIcons.setTraySizes(TrayIconRenderer::traySizesForScreens());
+    m_trayIcons.prewarm();
+    m_lastTrayLevel = m_trayIcons.levelFor(m_lastTrayVolPct / 100.0);
+    applyTrayIcon(m_lastTrayLevel, m_lastTrayMuted);
+}
+
+void AppController::applyTrayIcon(int level, bool muted)
+{
+    // Different states can share pixels (e.g. muted at any level); skip the shell round-trip then.
+    const size_t key = m_trayIcons.pixelKey(level, muted);
+    if (m_trayIconApplied && key == m_appliedTrayPixelKey)
+        return;
+    m_tray.setIcon(m_trayIcons.icon(level, muted));
+    m_appliedTrayPixelKey = key;
+    m_trayIconApplied = true;
+    ++m_trayIconSets;
+}
+
 void AppController::positionFlyout()
 {
     if (!m_view)
@@ -1082,6 +1587,9 @@ bool AppController::eventFilter(QObject *watched, QEvent *event)
             if (m_popupDepth > 0)
                 return QObject::eventFilter(watched, event);
 
+            if (m_prewarming.load())
+                return QObject::eventFilter(watched, event);
+
             if (m_view && m_view->isVisible()) {
                 m_suppressNextTrayToggle = true;
                 if (!m_trayToggleSuppressTimer.isActive())
@@ -1146,8 +1654,6 @@ void AppController::rebuildHiddenMenus()
             seen.insert(d.id);
             addCheckItem(m_hiddenDevicesMenu, d.name, m_config->isDeviceHidden(d.id), [this, id = d.id](bool checked) {
                 m_config->setDeviceHidden(id, checked);
-                m_audio->refresh(); // re-filter
-                emit hiddenItemsChanged();
             });
         }
 
@@ -1157,8 +1663,6 @@ void AppController::rebuildHiddenMenus()
                 continue;
             addCheckItem(m_hiddenDevicesMenu, tr("[disconnected] %1").arg(hiddenId), true, [this, id = hiddenId](bool checked) {
                 m_config->setDeviceHidden(id, checked);
-                m_audio->refresh();
-                emit hiddenItemsChanged();
             });
         }
     }
@@ -1204,9 +1708,6 @@ void AppController::rebuildHiddenMenus()
             const QString label = nameByExe.value(exe).isEmpty() ? exe : nameByExe.value(exe);
             addCheckItem(globalMenu, label, m_config->isProcessHiddenGlobal(exe), [this, exe](bool checked) {
                 m_config->setProcessHiddenGlobal(exe, checked);
-                m_audio->refresh();
-                rebuildHiddenMenus();
-                requestRelayout();
             });
         }
     }
@@ -1256,9 +1757,6 @@ void AppController::rebuildHiddenMenus()
             const QString label = perNameByExe.value(exe).isEmpty() ? exe : perNameByExe.value(exe);
             addCheckItem(devMenu, label, m_config->isProcessHiddenForDevice(d.id, exe), [this, devId = d.id, exe](bool checked) {
                 m_config->setProcessHiddenForDevice(devId, exe, checked);
-                m_audio->refresh();
-                rebuildHiddenMenus();
-                requestRelayout();
             });
         }
     }
@@ -1304,9 +1802,6 @@ void AppController::rebuildHiddenMenus()
                 const QString label = perNameByExe.value(exe).isEmpty() ? exe : perNameByExe.value(exe);
                 addCheckItem(devMenu, label, m_config->isProcessHiddenForDevice(devId, exe), [this, devId, exe](bool checked) {
                     m_config->setProcessHiddenForDevice(devId, exe, checked);
-                    m_audio->refresh();
-                    rebuildHiddenMenus();
-                    requestRelayout();
                 });
             }
         }
@@ -1,34 +1,61 @@
 #include "AudioBackend.h"
 
 #include "AudioDevice.h"
-#include "AudioSession.h"
 #include "AudioWorker.h"
 #include "ConfigStore.h"
 #include "DeviceListModel.h"
 #include "IconCache.h"
+#include "Metrics.h"
 #include "SessionListModel.h"
+#include "StateCache.h"
+#include "Tracer.h"
 #include "UpdateCoalescer.h"
+#include "VolumeCommitScheduler.h"
 
 #include <QDateTime>
 #include <QSet>
 #include <QStringList>
 
-static QString sessionKeyStr(quint32 pid, const QString &exePath);
+#include <utility>
 
 AudioBackend::AudioBackend(QObject *parent)
+    : AudioBackend(parent, true)
+{
+}
+
+AudioBackend::AudioBackend(QObject *parent, bool withIconCache)
     : QObject(parent)
 {
     qRegisterMetaType<QVector<DeviceState>>("QVector<DeviceState>");
     qRegisterMetaType<QVector<SessionPeak>>("QVector<SessionPeak>");
+    qRegisterMetaType<QVector<VolumeTarget>>("QVector<VolumeTarget>");
+    m_startupClock.start();
 
     m_deviceModel = new DeviceListModel(this);
-    // The QQmlEngine will take ownership when we addImageProvider("appicon", ...).
-    m_iconCache = new IconCache();
+    if (withIconCache) {
+        // The QQmlEngine will take ownership when we addImageProvider("appicon", ...).
+        m_iconCache = new IconCache();
+        connect(m_iconCache, &IconCache::iconReady, this, [this](const QString &exePath, const QString &iconKey) {
+            for (auto *dev : std::as_const(m_deviceById))
+                dev->sessionsModelTyped()->setIconKeyForExePath(exePath, iconKey);
+        });
+    }
     m_coalescer = new UpdateCoalescer(this);
+    m_volumeCommits = new VolumeCommitScheduler(this);
+    connect(m_volumeCommits, &VolumeCommitScheduler::batchReady, this, &AudioBackend::commitVolumes);
+
+    // A slider drag remembers a level every commit; hand the worker one table copy per pause.
+    m_appVolumePushDebounce.setSingleShot(true);
+    m_appVolumePushDebounce.setInterval(kAppVolumePushDelayMs);
+    connect(&m_appVolumePushDebounce, &QTimer::timeout, this, &AudioBackend::pushAppVolumeTable);
 }
 
 AudioBackend::~AudioBackend()
 {
+    // Only live state is worth restoring next time; a run that never got a snapshot keeps the old cache.
+    if (!m_stale && !m_lastSnapshot.isEmpty())
+        StateCache::save(m_lastSnapshot);
+
     if (m_worker) {
         QMetaObject::invokeMethod(m_worker, &AudioWorker::stop, Qt::BlockingQueuedConnection);
         m_worker = nullptr;
@@ -39,7 +66,85 @@ AudioBackend::~AudioBackend()
 
 void AudioBackend::setConfig(ConfigStore *cfg)
 {
+    if (m_config)
+        disconnect(m_config, nullptr, this, nullptr);
     m_config = cfg;
+    pushAppVolumeTable();
+    if (m_config) {
+        connect(m_config, &ConfigStore::changesCommitted, this, &AudioBackend::onConfigChanged);
+        m_hiddenRules.compile(m_config->hiddenProcessesGlobalSet(), m_config->hiddenProcessesPerDeviceMap());
+    } else {
+        m_hiddenRules.compile({}, {});
+    }
+}
+
+void AudioBackend::onConfigChanged(const ConfigStore::ChangeSet &changes)
+{
+    using CS = ConfigStore::ChangeSet;
+
+    if (changes.has(CS::RememberAppVolumesField))
+        pushAppVolumeTable();
+    else if (changes.has(CS::AppVolumesField) && !m_appVolumePushDebounce.isActive())
+        m_appVolumePushDebounce.start();
+
+    const bool processRulesChanged = changes.has(CS::HiddenProcessesGlobalField | CS::HiddenProcessesPerDeviceField);
+    if (processRulesChanged && m_config)
+        m_hiddenRules.compile(m_config->hiddenProcessesGlobalSet(), m_config->hiddenProcessesPerDeviceMap());
+
+    // Device visibility decides which rows exist at all; re-apply the whole snapshot.
+    if (changes.has(CS::HiddenDevicesField)) {
+        refresh();
+        return;
+    }
+
+    bool processesChanged = false;
+    if (processRulesChanged) {
+        // Exact-path rules only affect devices that currently have a session of that exe;
+        // a pattern rule (basename, folder, glob) may match anything.
+        bool anyPattern = false;
+        QSet<QString> exactRules;
+        for (const auto &rule : changes.exePaths) {
+            if (!HiddenRuleMatcher::isExactRule(rule)) {
+                anyPattern = true;
+                break;
+            }
+            exactRules.insert(HiddenRuleMatcher::normalize(rule));
+        }
+
+        for (const auto &ds : std::as_const(m_lastSnapshot)) {
+            AudioDevice *dev = m_deviceById.value(ds.id, nullptr);
+            if (!dev)
+                continue;
+            const bool perDevice = changes.has(CS::HiddenProcessesPerDeviceField) && changes.deviceIds.contains(ds.id);
+            if (!perDevice && !changes.has(CS::HiddenProcessesGlobalField))
+                continue;
+            bool affected = anyPattern;
+            for (qsizetype i = 0; !affected && i < ds.sessions.size(); ++i)
+                affected = exactRules.contains(HiddenRuleMatcher::normalize(ds.sessions.at(i).exePath));
+            if (affected && syncDeviceSessions(dev, ds, nullptr))
+                processesChanged = true;
+        }
+
+        if (processesChanged && m_iconCache) {
+            QSet<QString> shown;
+            for (auto *dev : std::as_const(m_deviceById)) {
+                const SessionListModel *sessions = dev->sessionsModelTyped();
+                for (int i = 0; i < sessions->rowCount(); ++i)
+                    shown.insert(sessions->exePathAt(i));
+            }
+            m_iconCache->setPinnedExePaths(shown);
+        }
+    }
+
+    bool devicesMoved = false;
+    if (changes.has(CS::DeviceOrderField)) {
+        QSet<QString> keep;
+        for (auto it = m_deviceById.cbegin(); it != m_deviceById.cend(); ++it)
+            keep.insert(it.key());
+        devicesMoved = applyConfiguredDeviceOrder(keep);
+    }
+
+    rebuildMenusIfChanged(devicesMoved, processesChanged, false);
 }
 
 void AudioBackend::setAllDevices(bool all)
@@ -56,26 +161,108 @@ void AudioBackend::setShowSystemSessions(bool show)
     refresh();
 }
 
+void AudioBackend::applyWarmStart()
+{
+    if (!m_lastSnapshot.isEmpty())
+        return;
+    const QVector<DeviceState> cached = StateCache::load();
+    if (cached.isEmpty())
+        return;
+
+    m_warmStartDevices = cached.size();
+    for (const auto &ds : cached)
+        m_warmStartSessions += ds.sessions.size();
+
+    m_lastSnapshot = cached;
+    m_stale = true;
+    applySnapshot(cached);
+    m_warmStartAppliedMs = m_startupClock.elapsed();
+    emit staleChanged();
+}
+
+void AudioBackend::onLiveSnapshot(const QVector<DeviceState> &devices)
+{
+    // The live snapshot is diffed against the warm rows like any other update: rows that still
+    // exist keep their delegates, stale ones (e.g. processes that exited since) are removed.
+    m_lastSnapshot = devices;
+    applySnapshot(devices);
+    if (m_firstSnapshotMs < 0)
+        m_firstSnapshotMs = m_startupClock.elapsed();
+    if (m_stale) {
+        m_stale = false;
+        emit staleChanged();
+    }
+}
+
+void AudioBackend::pushAppVolumeTable()
+{
+    m_appVolumePushDebounce.stop();
+    if (!m_worker)
+        return;
+    // Copy-on-write: the worker keeps its own immutable snapshot for the COM notification thread.
+    m_worker->setAppVolumeTable(m_config && m_config->rememberAppVolumes() ? m_config->appVolumes() : AppVolumeTable());
+}
+
+void AudioBackend::noteChangesApplied(const QVector<qint64> &changeStampsNs)
+{
+    if (changeStampsNs.isEmpty())
+        return;
+    static auto &toApply = Metrics::instance().histogram(QStringLiteral("latency.externalToApply"));
+    const qint64 now = Metrics::nowNs();
+    for (const qint64 stamp : changeStampsNs)
+        toApply.record(now - stamp);
+    // Nobody collects these while the flyout is hidden; keep only the newest.
+    m_appliedChangeStamps += changeStampsNs;
+    if (m_appliedChangeStamps.size() > kMaxAppliedChangeStamps)
+        m_appliedChangeStamps.remove(0, m_appliedChangeStamps.size() - kMaxAppliedChangeStamps);
+}
+
+QVariantMap AudioBackend::hiddenRuleStats() const
+{
+    return m_hiddenRules.stats();
+}
+
+QVariantMap AudioBackend::startupStats() const
+{
+    QVariantMap out;
+    out.insert(QStringLiteral("warmStartDevices"), m_warmStartDevices);
+    out.insert(QStringLiteral("warmStartSessions"), m_warmStartSessions);
+    out.insert(QStringLiteral("warmStartAppliedMs"), m_warmStartAppliedMs);
+    out.insert(QStringLiteral("firstSnapshotMs"), m_firstSnapshotMs);
+    out.insert(QStringLiteral("stale"), m_stale);
+    return out;
+}
+
 void AudioBackend::start()
 {
     if (m_worker)
         return;
 
+    // Populate the models from the previous run before COM is even initialized.
+    applyWarmStart();
+
     m_worker = new AudioWorker();
     m_worker->moveToThread(&m_workerThread);
+    pushAppVolumeTable();
 
     connect(&m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
-    connect(m_worker, &AudioWorker::snapshotReady, this, [this](const QVector<DeviceState> &devices) {
+    connect(m_worker, &AudioWorker::snapshotReady, this, [this](const QVector<DeviceState> &devices, quint64 traceFlow,
+                                                                const QVector<qint64> &changeStampsNs) {
+        Tracer::Span span("gui.snapshotReceived");
+        Tracer::flowStep(traceFlow);
+        const auto apply = [this, devices, traceFlow, changeStampsNs]() {
+            // Binds to the coalescer.flush span this runs in.
+            Tracer::flowStep(traceFlow);
+            m_traceFlow = traceFlow;
+            onLiveSnapshot(devices);
+            m_traceFlow = 0;
+            noteChangesApplied(changeStampsNs);
+        };
         // Coalesce on GUI thread to avoid thrashing QML bindings.
-        if (m_coalescer) {
-            m_coalescer->post([this, devices]() {
-                m_lastSnapshot = devices;
-                applySnapshot(devices);
-            });
-        } else {
-            m_lastSnapshot = devices;
-            applySnapshot(devices);
-        }
+        if (m_coalescer)
+            m_coalescer->post(apply);
+        else
+            apply();
     }, Qt::QueuedConnection);
     connect(m_worker, &AudioWorker::peaksReady, this, [this](const QVector<SessionPeak> &peaks) {
         if (m_coalescer) {
@@ -84,8 +271,17 @@ void AudioBackend::start()
             applyPeaks(peaks);
         }
     }, Qt::QueuedConnection);
-    connect(m_worker, &AudioWorker::error, this, [](const QString &msg) {
+    // Icons start decoding as soon as the worker first sees an executable, well before a row
+    // for it is realized.
+    if (m_iconCache)
+        connect(m_worker, &AudioWorker::executableSeen, m_iconCache, &IconCache::prefetch, Qt::QueuedConnection);
+    connect(m_worker, &AudioWorker::sceneApplied, this, &AudioBackend::onSceneApplied, Qt::QueuedConnection);
+    connect(m_worker, &AudioWorker::error, this, [this](const QString &msg) {
         qWarning("%s", qPrintable(msg));
+        Metrics::instance().counter(QStringLiteral("worker.errors")).add();
+        m_recentErrors.append(QDateTime::currentDateTime().toString(Qt::ISODate) + QLatin1Char(' ') + msg);
+        if (m_recentErrors.size() > kRecentErrorCount)
+            m_recentErrors.removeFirst();
     }, Qt::QueuedConnection);
 
     m_workerThread.start();
@@ -99,6 +295,9 @@ void AudioBackend::applyPeaks(const QVector<SessionPeak> &peaks)
     if (peaks.isEmpty())
         return;
 
+    static auto &applyTime = Metrics::instance().histogram(QStringLiteral("gui.applyPeaks"));
+    Metrics::ScopedTimer timer(applyTime);
+
     QHash<QString, double> maxPeakByDevice;
 
     for (const auto &p : peaks) {
@@ -109,17 +308,11 @@ void AudioBackend::applyPeaks(const QVector<SessionPeak> &peaks)
         if (maxIt == maxPeakByDevice.end() || p.peak > maxIt.value())
             maxPeakByDevice.insert(p.deviceId, p.peak);
 
-        auto devIt = m_sessionByKeyByDevice.find(p.deviceId);
-        if (devIt == m_sessionByKeyByDevice.end())
-            continue;
-
-        const QString keyStr = sessionKeyStr(p.pid, p.exePath);
-        auto sessIt = devIt->find(keyStr);
-        if (sessIt == devIt->end())
+        auto *dev = m_deviceById.value(p.deviceId, nullptr);
+        if (!dev)
             continue;
-
-        if (sessIt.value())
-            sessIt.value()->setPeakInternal(p.peak);
+        auto *sessions = dev->sessionsModelTyped();
+        sessions->setPeakAt(sessions->indexOf(p.pid, p.exePath), p.peak);
     }
 
     // Also drive a per-device peak meter (max of its sessions).
@@ -139,16 +332,20 @@ void AudioBackend::refresh()
         applySnapshot(m_lastSnapshot);
 }
 
-static QString sessionKeyStr(quint32 pid, const QString &exePath)
-{
-    return QString::number(pid) + QLatin1Char('|') + exePath;
-}
-
 void AudioBackend::applySnapshot(const QVector<DeviceState> &devices)
 {
     if (!m_deviceModel)
         return;
 
+    static auto &applied = Metrics::instance().counter(QStringLiteral("gui.snapshotsApplied"));
+    static auto &applyTime = Metrics::instance().histogram(QStringLiteral("gui.applySnapshot"));
+    Metrics::ScopedTimer timer(applyTime);
+    applied.add();
+    Tracer::Span span("gui.applySnapshot");
+    Tracer::flowStep(m_traceFlow);
+    // The next frame the flyout presents shows this snapshot.
+    Tracer::setFrameFlow(m_traceFlow);
+
     bool anyDevicesChanged = false;
     bool anyProcessesChanged = false;
 
@@ -160,6 +357,7 @@ void AudioBackend::applySnapshot(const QVector<DeviceState> &devices)
     bool defMuted = false;
 
     QSet<QString> keepDeviceIds;
+    QSet<QString> shownExePaths;
 
     for (const auto &ds : devices) {
         if (ds.id.isEmpty())
@@ -197,96 +395,17 @@ void AudioBackend::applySnapshot(const QVector<DeviceState> &devices)
         dev->setVolumeInternal(ds.volume);
         dev->setMutedInternal(ds.muted);
 
-        // Sessions diff per device.
-        auto &map = m_sessionByKeyByDevice[ds.id];
-        QSet<QString> keepSessions;
-
-        for (const auto &ss : ds.sessions) {
-            if (ss.pid == 0 || ss.exePath.isEmpty())
-                continue;
-
-            if (m_config) {
-                if (m_config->isProcessHiddenGlobal(ss.exePath))
-                    continue;
-                if (m_config->isProcessHiddenForDevice(ds.id, ss.exePath))
-                    continue;
-            }
-
-            const QString key = sessionKeyStr(ss.pid, ss.exePath);
-            keepSessions.insert(key);
-
-            AudioSession *sess = map.value(key, nullptr);
-            if (!sess) {
-                sess = new AudioSession(this, ds.id, ss.pid, ss.exePath, this);
-                sess->setDisplayName(ss.displayName);
-                sess->setIconKey(m_iconCache ? m_iconCache->ensureIconForExePath(ss.exePath) : ss.exePath);
-                sess->setVolumeInternal(ss.volume);
-                sess->setMutedInternal(ss.muted);
-                sess->setActiveInternal(ss.active);
-                map.insert(key, sess);
-            } else {
-                sess->setDisplayName(ss.displayName);
-                sess->setIconKey(m_iconCache ? m_iconCache->ensureIconForExePath(ss.exePath) : ss.exePath);
-                sess->setVolumeInternal(ss.volume);
-                sess->setMutedInternal(ss.muted);
-                sess->setActiveInternal(ss.active);
-            }
-
-            // Ensure it's present in the model (it may exist in cache but be filtered out previously).
-            if (dev->sessionsModelTyped()->indexOf(sess->pid(), sess->exePath()) < 0) {
-                dev->sessionsModelTyped()->insertSession(dev->sessionsModelTyped()->rowCount(), sess);
-                anyProcessesChanged = true;
-            }
-        }
-
-        // Remove missing sessions.
-        const auto existingKeys = map.keys();
-        for (const auto &k : existingKeys) {
-            if (keepSessions.contains(k))
-                continue;
-            AudioSession *sess = map.value(k, nullptr);
-            if (!sess)
-                continue;
-            const int row = dev->sessionsModelTyped()->indexOf(sess->pid(), sess->exePath());
-            if (row >= 0) {
-                dev->sessionsModelTyped()->removeSessionAt(row);
-                anyProcessesChanged = true;
-            }
-            map.remove(k);
-            delete sess;
-        }
+        if (syncDeviceSessions(dev, ds, &shownExePaths))
+            anyProcessesChanged = true;
     }
 
-    // Apply user-defined device order (from config), keeping any remaining devices after.
-    if (m_config && m_deviceModel) {
-        QStringList desired;
-        const QStringList cfgOrder = m_config->deviceOrder();
-        QSet<QString> inDesired;
-        for (const auto &id : cfgOrder) {
-            if (keepDeviceIds.contains(id) && m_deviceModel->indexOfDeviceId(id) >= 0) {
-                desired.append(id);
-                inDesired.insert(id);
-            }
-        }
-        // Append the rest in current model order.
-        for (int i = 0; i < m_deviceModel->rowCount(); ++i) {
-            auto *d = m_deviceModel->deviceAt(i);
-            if (!d) continue;
-            if (!keepDeviceIds.contains(d->id())) continue;
-            if (inDesired.contains(d->id())) continue;
-            desired.append(d->id());
-            inDesired.insert(d->id());
-        }
+    // Icons of sessions on screen must survive the cache's LRU eviction.
+    if (m_iconCache)
+        m_iconCache->setPinnedExePaths(shownExePaths);
 
-        // Reorder model to match desired list.
-        for (int targetRow = 0; targetRow < desired.size(); ++targetRow) {
-            const int curRow = m_deviceModel->indexOfDeviceId(desired.at(targetRow));
-            if (curRow >= 0 && curRow != targetRow) {
-                m_deviceModel->moveDevice(curRow, targetRow);
-                anyDevicesChanged = true;
-            }
-        }
-    }
+    // Apply user-defined device order (from config), keeping any remaining devices after.
+    if (applyConfiguredDeviceOrder(keepDeviceIds))
+        anyDevicesChanged = true;
 
     // Remove devices no longer present/visible.
     const auto existingDeviceIds = m_deviceById.keys();
@@ -324,6 +443,78 @@ void AudioBackend::applySnapshot(const QVector<DeviceState> &devices)
     rebuildMenusIfChanged(anyDevicesChanged, anyProcessesChanged, defaultChanged);
 }
 
+bool AudioBackend::syncDeviceSessions(AudioDevice *dev, const DeviceState &ds, QSet<QString> *shownExePaths)
+{
+    bool changed = false;
+    SessionListModel *sessions = dev->sessionsModelTyped();
+    QSet<QString> keepSessions;
+
+    for (const auto &ss : ds.sessions) {
+        if (ss.pid == 0 || ss.exePath.isEmpty())
+            continue;
+
+        if (m_hiddenRules.isHidden(ds.id, ss.exePath))
+            continue;
+
+        keepSessions.insert(SessionListModel::sessionKey(ss.pid, ss.exePath));
+        if (shownExePaths)
+            shownExePaths->insert(ss.exePath);
+
+        SessionListModel::Fields f;
+        f.pid = ss.pid;
+        f.exePath = ss.exePath;
+        f.displayName = ss.displayName;
+        // Non-blocking: a placeholder key until the icon pool has extracted the real one.
+        f.iconKey = m_iconCache ? m_iconCache->ensureIconForExePath(ss.exePath) : ss.exePath;
+        f.volume = ss.volume;
+        f.muted = ss.muted;
+        f.active = ss.active;
+        if (sessions->upsert(f))
+            changed = true;
+    }
+
+    // Remove missing sessions.
+    if (sessions->removeAllExcept(keepSessions) > 0)
+        changed = true;
+    return changed;
+}
+
+bool AudioBackend::applyConfiguredDeviceOrder(const QSet<QString> &keep)
+{
+    // User-defined order (from config) first, then any remaining devices in current model order.
+    bool moved = false;
+    if (m_config && m_deviceModel) {
+        QStringList desired;
+        const QStringList cfgOrder = m_config->deviceOrder();
+        QSet<QString> inDesired;
+        for (const auto &id : cfgOrder) {
+            if (keep.contains(id) && m_deviceModel->indexOfDeviceId(id) >= 0) {
+                desired.append(id);
+                inDesired.insert(id);
+            }
+        }
+        // Append the rest in current model order.
+        for (int i = 0; i < m_deviceModel->rowCount(); ++i) {
+            auto *d = m_deviceModel->deviceAt(i);
+            if (!d) continue;
+            if (!keep.contains(d->id())) continue;
+            if (inDesired.contains(d->id())) continue;
+            desired.append(d->id());
+            inDesired.insert(d->id());
+        }
+
+        // Reorder model to match desired list.
+        for (int targetRow = 0; targetRow < desired.size(); ++targetRow) {
+            const int curRow = m_deviceModel->indexOfDeviceId(desired.at(targetRow));
+            if (curRow >= 0 && curRow != targetRow) {
+                m_deviceModel->moveDevice(curRow, targetRow);
+                moved = true;
+            }
+        }
+    }
+    return moved;
+}
+
 void AudioBackend::moveDeviceBefore(const QString &movingDeviceId, const QString &beforeDeviceId)
 {
     if (!m_deviceModel || !m_config)
@@ -427,14 +618,14 @@ QVector<AudioBackend::ProcessSnapshot> AudioBackend::knownProcessesSnapshot() co
 QVector<AudioBackend::ProcessSnapshot> AudioBackend::knownProcessesForDeviceSnapshot(const QString &deviceId) const
 {
     QHash<QString, QString> uniq;
-    const auto sessions = m_sessionByKeyByDevice.value(deviceId);
-    for (auto *s : sessions) {
-        if (!s)
-            continue;
-        const QString exe = s->exePath();
-        if (exe.isEmpty())
-            continue;
-        uniq.insert(exe, s->displayName());
+    if (auto *dev = m_deviceById.value(deviceId, nullptr)) {
+        const SessionListModel *sessions = dev->sessionsModelTyped();
+        for (int row = 0; row < sessions->rowCount(); ++row) {
+            const QString exe = sessions->exePathAt(row);
+            if (exe.isEmpty())
+                continue;
+            uniq.insert(exe, sessions->displayNameAt(row));
+        }
     }
     QVector<ProcessSnapshot> out;
     out.reserve(uniq.size());
@@ -467,12 +658,12 @@ QVector<AudioBackend::ProcessSnapshot> AudioBackend::knownProcessesForDeviceSnap
 
 void AudioBackend::setDeviceVolume(const QString &deviceId, double volume01)
 {
-    if (auto *d = m_deviceById.value(deviceId, nullptr))
-        d->setVolumeInternal(volume01);
-
-    if (m_worker)
-        QMetaObject::invokeMethod(m_worker, "setDeviceVolume", Qt::QueuedConnection,
-                                  Q_ARG(QString, deviceId), Q_ARG(double, volume01));
+    VolumeTarget t;
+    t.kind = VolumeTarget::Kind::Device;
+    t.deviceId = deviceId;
+    t.volume = volume01;
+    t.requestedAtNs = Metrics::nowNs();
+    m_volumeCommits->schedule(t);
 }
 
 void AudioBackend::setDeviceMuted(const QString &deviceId, bool muted)
@@ -487,21 +678,30 @@ void AudioBackend::setDeviceMuted(const QString &deviceId, bool muted)
 
 void AudioBackend::setSessionVolume(const QString &deviceId, quint32 pid, const QString &exePath, double volume01)
 {
-    const QString key = sessionKeyStr(pid, exePath);
-    if (auto *s = m_sessionByKeyByDevice.value(deviceId).value(key, nullptr))
-        s->setVolumeInternal(volume01);
-
-    if (m_worker)
-        QMetaObject::invokeMethod(m_worker, "setSessionVolume", Qt::QueuedConnection,
-                                  Q_ARG(QString, deviceId), Q_ARG(quint32, pid),
-                                  Q_ARG(QString, exePath), Q_ARG(double, volume01));
+    // Warm-start rows carry PIDs from the previous run; they may be gone or reused by now.
+    if (m_stale)
+        return;
+    VolumeTarget t;
+    t.kind = VolumeTarget::Kind::Session;
+    t.deviceId = deviceId;
+    t.pid = pid;
+    t.exePath = exePath;
+    t.volume = volume01;
+    t.requestedAtNs = Metrics::nowNs();
+    m_volumeCommits->schedule(t);
 }
 
 void AudioBackend::setSessionMuted(const QString &deviceId, quint32 pid, const QString &exePath, bool muted)
 {
-    const QString key = sessionKeyStr(pid, exePath);
-    if (auto *s = m_sessionByKeyByDevice.value(deviceId).value(key, nullptr))
-        s->setMutedInternal(muted);
+    if (m_stale)
+        return;
+    if (auto *d = m_deviceById.value(deviceId, nullptr)) {
+        auto *sessions = d->sessionsModelTyped();
+        const int row = sessions->indexOf(pid, exePath);
+        sessions->setMutedAt(row, muted);
+        if (m_config && row >= 0)
+            m_config->rememberAppVolume(deviceId, exePath, sessions->volumeAt(row), muted);
+    }
 
     if (m_worker)
         QMetaObject::invokeMethod(m_worker, "setSessionMuted", Qt::QueuedConnection,
@@ -509,6 +709,169 @@ void AudioBackend::setSessionMuted(const QString &deviceId, quint32 pid, const Q
                                   Q_ARG(QString, exePath), Q_ARG(bool, muted));
 }
 
+void AudioBackend::commitVolumes(const QVector<VolumeTarget> &targets)
+{
+    if (targets.isEmpty())
+        return;
+
+    // One config notification (and one debounced save) for all remembered app levels in the batch.
+    ConfigStore::Batch batch(m_config);
+    for (const auto &t : targets) {
+        if (t.kind == VolumeTarget::Kind::Device) {
+            if (auto *d = m_deviceById.value(t.deviceId, nullptr))
+                d->setVolumeInternal(t.volume);
+            continue;
+        }
+        if (auto *d = m_deviceById.value(t.deviceId, nullptr)) {
+            auto *sessions = d->sessionsModelTyped();
+            const int row = sessions->indexOf(t.pid, t.exePath);
+            sessions->setVolumeAt(row, t.volume);
+            if (m_config && row >= 0)
+                m_config->rememberAppVolume(t.deviceId, t.exePath, t.volume, sessions->mutedAt(row));
+        }
+    }
+
+    if (m_worker)
+        QMetaObject::invokeMethod(m_worker, &AudioWorker::setVolumes, Qt::QueuedConnection, targets);
+}
+
+VolumeScene AudioBackend::captureScene(const QString &name) const
+{
+    VolumeScene scene;
+    scene.name = name;
+    for (const auto &ds : m_lastSnapshot) {
+        if (ds.id.isEmpty())
+            continue;
+        VolumeTarget dt;
+        dt.kind = VolumeTarget::Kind::Device;
+        dt.deviceId = ds.id;
+        dt.volume = ds.volume;
+        dt.applyMute = true;
+        dt.muted = ds.muted;
+        scene.targets.append(dt);
+
+        // One target per executable: several sessions of the same app share its level.
+        QSet<QString> seen;
+        for (const auto &ss : ds.sessions) {
+            if (ss.exePath.isEmpty() || seen.contains(ss.exePath.toCaseFolded()))
+                continue;
+            seen.insert(ss.exePath.toCaseFolded());
+            VolumeTarget st;
+            st.kind = VolumeTarget::Kind::Session;
+            st.deviceId = ds.id;
+            st.exePath = ss.exePath;
+            st.volume = ss.volume;
+            st.applyMute = true;
+            st.muted = ss.muted;
+            scene.targets.append(st);
+        }
+    }
+    return scene;
+}
+
+void AudioBackend::applyScene(const VolumeScene &scene)
+{
+    if (scene.targets.isEmpty())
+        return;
+    const qint64 requestedAtNs = Metrics::nowNs();
+
+    QHash<QString, const VolumeTarget *> byExe; // appVolumeKey(deviceId, exe)
+    for (const auto &t : scene.targets) {
+        if (t.kind == VolumeTarget::Kind::Session) {
+            byExe.insert(appVolumeKey(t.deviceId, t.exePath), &t);
+            continue;
+        }
+        if (auto *d = m_deviceById.value(t.deviceId, nullptr)) {
+            d->setVolumeInternal(t.volume);
+            if (t.applyMute)
+                d->setMutedInternal(t.muted);
+        }
+    }
+    if (!byExe.isEmpty()) {
+        for (auto *d : std::as_const(m_deviceById)) {
+            auto *sessions = d->sessionsModelTyped();
+            for (int row = 0; row < sessions->rowCount(); ++row) {
+                const VolumeTarget *t = byExe.value(appVolumeKey(d->id(), sessions->exePathAt(row)), nullptr);
+                if (!t)
+                    continue;
+                sessions->setVolumeAt(row, t->volume);
+                if (t->applyMute)
+                    sessions->setMutedAt(row, t->muted);
+            }
+        }
+    }
+
+    if (m_worker)
+        QMetaObject::invokeMethod(m_worker, &AudioWorker::applyScene, Qt::QueuedConnection, scene.targets, requestedAtNs,
+                                  false);
+}
+
+void AudioBackend::measureSceneApply(int targetCount, int runs)
+{
+    // Exact-pid session targets: each one is a separate COM write, unlike the per-exe targets
+    // of a captured scene, so the batch really holds targetCount writes. Only the ids matter:
+    // the worker writes back whatever level each object has when the run reaches it.
+    QVector<VolumeTarget> current;
+    for (const auto &ds : std::as_const(m_lastSnapshot)) {
+        VolumeTarget dt;
+        dt.kind = VolumeTarget::Kind::Device;
+        dt.deviceId = ds.id;
+        dt.applyMute = true;
+        current.append(dt);
+        for (const auto &ss : ds.sessions) {
+            VolumeTarget st;
+            st.kind = VolumeTarget::Kind::Session;
+            st.deviceId = ds.id;
+            st.pid = ss.pid;
+            st.exePath = ss.exePath;
+            st.applyMute = true;
+            current.append(st);
+        }
+    }
+    if (current.isEmpty() || targetCount <= 0 || !m_worker || !m_measureTargets.isEmpty())
+        return;
+
+    m_measureTargets.clear();
+    m_measureTargets.reserve(targetCount);
+    for (int i = 0; i < targetCount; ++i)
+        m_measureTargets.append(current.at(i % current.size()));
+    m_measureRunsLeft = runs;
+    // One in flight at a time, so no run's latency includes waiting behind the previous one.
+    if (m_measureRunsLeft-- > 0)
+        QMetaObject::invokeMethod(m_worker, &AudioWorker::applyScene, Qt::QueuedConnection, m_measureTargets,
+                                  Metrics::nowNs(), true);
+}
+
+void AudioBackend::onSceneApplied(int targets, int written, qint64 queuedNs, qint64 writeNs, bool measurement)
+{
+    m_lastSceneTargets = targets;
+    m_lastSceneWritten = written;
+    m_sceneApplyLatency.record(queuedNs + writeNs);
+    m_sceneWriteLatency.record(writeNs);
+
+    // A user's scene finishing mid-run is recorded like any other but does not drive the run.
+    if (!measurement)
+        return;
+    if (m_measureRunsLeft-- > 0 && m_worker) {
+        QMetaObject::invokeMethod(m_worker, &AudioWorker::applyScene, Qt::QueuedConnection, m_measureTargets,
+                                  Metrics::nowNs(), true);
+        return;
+    }
+    m_measureRunsLeft = 0;
+    m_measureTargets.clear();
+}
+
+QVariantMap AudioBackend::sceneStats() const
+{
+    QVariantMap out;
+    out.insert(QStringLiteral("applies"), m_sceneApplyLatency.count());
+    out.insert(QStringLiteral("lastTargets"), m_lastSceneTargets);
+    out.insert(QStringLiteral("lastWritten"), m_lastSceneWritten);
+    out.insert(QStringLiteral("applyLatency"), m_sceneApplyLatency.toVariantMap());
+    out.insert(QStringLiteral("writeLatency"), m_sceneWriteLatency.toVariantMap());
+    return out;
+}
+
 void AudioBackend::rebuildMenusIfChanged(bool devicesChangedNow, bool processesChangedNow, bool defaultDeviceChangedNow)
 {
     if (devicesChangedNow)
@@ -11,12 +11,7 @@ AudioDevice::AudioDevice(AudioBackend *backend, const QString &id, const QString
     , m_id(id)
     , m_name(name)
 {
-    m_sessions = new SessionListModel(this);
-
-    m_volumeCommitTimer.setSingleShot(true);
-    m_volumeCommitTimer.setInterval(16);
-    m_volumeCommitTimer.setParent(this);
-    connect(&m_volumeCommitTimer, &QTimer::timeout, this, &AudioDevice::flushPendingVolume);
+    m_sessions = new SessionListModel(backend, id, this);
 }
 
 void AudioDevice::setName(const QString &n)
@@ -63,9 +58,8 @@ void AudioDevice::setPeakInternal(double p)
 
 void AudioDevice::setVolume(double v)
 {
-    m_pendingVolume = qBound(0.0, v, 1.0);
-    if (!m_volumeCommitTimer.isActive())
-        m_volumeCommitTimer.start();
+    if (m_backend)
+        m_backend->setDeviceVolume(m_id, v);
 }
 
 void AudioDevice::setMuted(bool m)
@@ -79,14 +73,3 @@ void AudioDevice::toggleMute()
     setMuted(!muted());
 }
 
-void AudioDevice::flushPendingVolume()
-{
-    if (m_pendingVolume < 0.0)
-        return;
-    const double v = m_pendingVolume;
-    m_pendingVolume = -1.0;
-    if (m_backend)
-        m_backend->setDeviceVolume(m_id, v);
-}
-
-
@@ -1,5 +1,7 @@
 #include "AudioWorker.h"
 
+#include "Metrics.h"
+#include "Tracer.h"
 #include "win/ComPtr.h"
 #include "win/Hr.h"
 
@@ -11,6 +13,7 @@
 
 #include <atomic>
 #include <unordered_map>
+#include <utility>
 
 #include <windows.h>
 #include <mmdeviceapi.h>
@@ -32,6 +35,10 @@ struct IAudioMeterInformation : public IUnknown
 
 static const IID IID_IAudioMeterInformation = {0xc02216f6, 0x8c67, 0x4b5b, {0x9d, 0x00, 0xd0, 0x08, 0xe7, 0x3e, 0x00, 0x64}};
 
+// Event context passed with every volume/mute write Earie makes, so the notifications they cause
+// can be told apart from changes made by other apps or the Windows mixer.
+static const GUID kEarieEventContext = {0x6d0c3f52, 0x8a4e, 0x4b1f, {0x9c, 0x37, 0x52, 0x1e, 0xa4, 0x0b, 0x7d, 0xe1}};
+
 static QString deviceFriendlyName(IMMDevice *device)
 {
     if (!device)
@@ -135,6 +142,8 @@ struct AudioWorker::Impl
         ComPtr<IMMDevice> device;
         ComPtr<IAudioEndpointVolume> endpoint;
         ComPtr<IAudioSessionManager2> sessionMgr;
+        // Per device so OnSessionCreated knows which endpoint the new session belongs to.
+        ComPtr<IAudioSessionNotification> sessionCb;
     };
 
     struct QStringHash {
@@ -143,7 +152,22 @@ struct AudioWorker::Impl
 
     std::unordered_map<QString, DeviceCom, QStringHash> devices; // deviceId -> com
     std::unordered_map<SessionKey, SessionCom, SessionKeyHash> sessions;
-    QHash<QString, qint64> lastActiveByKeyStr; // stable grace tracking across rebuilds
+
+    // COM callback (any thread) -> snapshot on the worker thread. The trace flow started here
+    // follows the change into the snapshot that picks it up; changeStampNs (set for volume/mute
+    // changes made outside Earie) rides along to the frame that displays it.
+    static void notifyChange(AudioWorker *w, const char *callback, qint64 changeStampNs = 0)
+    {
+        if (!w || w->m_destroying.load())
+            return;
+        Tracer::Span span(callback);
+        const quint64 flow = Tracer::newFlowId();
+        Tracer::flowStart(flow);
+        QMetaObject::invokeMethod(w, [w, flow, changeStampNs]() {
+            if (!w->m_destroying.load())
+                w->scheduleSnapshot(flow, changeStampNs);
+        }, Qt::QueuedConnection);
+    }
 
     // Callbacks
     class NotificationClient final : public IMMNotificationClient
@@ -182,11 +206,7 @@ struct AudioWorker::Impl
         HRESULT STDMETHODCALLTYPE OnPropertyValueChanged(LPCWSTR, const PROPERTYKEY) override { ping(); return S_OK; }
 
     private:
-        void ping()
-        {
-            if (m_worker && !m_worker->m_destroying.load())
-                QMetaObject::invokeMethod(m_worker, [this]() { if (m_worker && !m_worker->m_destroying.load()) m_worker->scheduleSnapshot(); }, Qt::QueuedConnection);
-        }
+        void ping() { notifyChange(m_worker, "com.deviceNotification"); }
 
         std::atomic<ULONG> m_ref{1};
         AudioWorker *m_worker = nullptr;
@@ -221,10 +241,10 @@ struct AudioWorker::Impl
             return E_NOINTERFACE;
         }
 
-        HRESULT STDMETHODCALLTYPE OnNotify(PAUDIO_VOLUME_NOTIFICATION_DATA) override
+        HRESULT STDMETHODCALLTYPE OnNotify(PAUDIO_VOLUME_NOTIFICATION_DATA data) override
         {
-            if (m_worker && !m_worker->m_destroying.load())
-                QMetaObject::invokeMethod(m_worker, [this]() { if (m_worker && !m_worker->m_destroying.load()) m_worker->scheduleSnapshot(); }, Qt::QueuedConnection);
+            const bool external = !data || !IsEqualGUID(data->guidEventContext, kEarieEventContext);
+            notifyChange(m_worker, "com.endpointVolume", external ? Metrics::nowNs() : 0);
             return S_OK;
         }
 
@@ -265,18 +285,19 @@ struct AudioWorker::Impl
 
         HRESULT STDMETHODCALLTYPE OnDisplayNameChanged(LPCWSTR, LPCGUID) override { ping(); return S_OK; }
         HRESULT STDMETHODCALLTYPE OnIconPathChanged(LPCWSTR, LPCGUID) override { ping(); return S_OK; }
-        HRESULT STDMETHODCALLTYPE OnSimpleVolumeChanged(float, BOOL, LPCGUID) override { ping(); return S_OK; }
+        HRESULT STDMETHODCALLTYPE OnSimpleVolumeChanged(float, BOOL, LPCGUID context) override
+        {
+            const bool external = !context || !IsEqualGUID(*context, kEarieEventContext);
+            notifyChange(m_worker, "com.sessionVolume", external ? Metrics::nowNs() : 0);
+            return S_OK;
+        }
         HRESULT STDMETHODCALLTYPE OnChannelVolumeChanged(DWORD, float[], DWORD, LPCGUID) override { return S_OK; }
         HRESULT STDMETHODCALLTYPE OnGroupingParamChanged(LPCGUID, LPCGUID) override { return S_OK; }
         HRESULT STDMETHODCALLTYPE OnStateChanged(AudioSessionState) override { ping(); return S_OK; }
         HRESULT STDMETHODCALLTYPE OnSessionDisconnected(AudioSessionDisconnectReason) override { ping(); return S_OK; }
 
     private:
-        void ping()
-        {
-            if (m_worker && !m_worker->m_destroying.load())
-                QMetaObject::invokeMethod(m_worker, [this]() { if (m_worker && !m_worker->m_destroying.load()) m_worker->scheduleSnapshot(); }, Qt::QueuedConnection);
-        }
+        void ping() { notifyChange(m_worker, "com.sessionEvent"); }
 
         std::atomic<ULONG> m_ref{1};
         AudioWorker *m_worker = nullptr;
@@ -286,8 +307,9 @@ struct AudioWorker::Impl
     class SessionNotification final : public IAudioSessionNotification
     {
     public:
-        explicit SessionNotification(AudioWorker *w)
+        SessionNotification(AudioWorker *w, const QString &deviceId)
             : m_worker(w)
+            , m_deviceId(deviceId)
         {
         }
 
@@ -312,21 +334,55 @@ struct AudioWorker::Impl
             return E_NOINTERFACE;
         }
 
-        HRESULT STDMETHODCALLTYPE OnSessionCreated(IAudioSessionControl *) override
+        HRESULT STDMETHODCALLTYPE OnSessionCreated(IAudioSessionControl *ctrl) override
         {
-            if (m_worker && !m_worker->m_destroying.load())
-                QMetaObject::invokeMethod(m_worker, [this]() { if (m_worker && !m_worker->m_destroying.load()) m_worker->scheduleSnapshot(); }, Qt::QueuedConnection);
+            if (!m_worker || m_worker->m_destroying.load())
+                return S_OK;
+            Tracer::Span span("com.sessionCreated");
+            const quint64 flow = Tracer::newFlowId();
+            Tracer::flowStart(flow);
+
+            // Resolve the executable right away so icon prefetch starts before the snapshot does.
+            QString exe;
+            ComPtr<IAudioSessionControl2> ctrl2;
+            if (ctrl && SUCCEEDED(ctrl->QueryInterface(__uuidof(IAudioSessionControl2), reinterpret_cast<void **>(ctrl2.put()))) && ctrl2) {
+                DWORD pid = 0;
+                if (SUCCEEDED(ctrl2->GetProcessId(&pid)) && pid != 0)
+                    exe = exePathForPid(pid);
+            }
+
+            // Restore the remembered level here, on the notification thread, before the app has
+            // produced much audio and before the GUI hears about the session.
+            AppVolume remembered;
+            if (!exe.isEmpty() && m_worker->rememberedVolume(m_deviceId, exe, &remembered)) {
+                ComPtr<ISimpleAudioVolume> simple;
+                if (SUCCEEDED(ctrl->QueryInterface(__uuidof(ISimpleAudioVolume), reinterpret_cast<void **>(simple.put()))) && simple) {
+                    simple->SetMasterVolume(static_cast<float>(qBound(0.0, remembered.volume, 1.0)), &kEarieEventContext);
+                    simple->SetMute(remembered.muted ? TRUE : FALSE, &kEarieEventContext);
+                    m_worker->m_appVolumesApplied.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            // Capture the worker, not this: the next snapshot may release this callback before
+            // the lambda runs.
+            AudioWorker *w = m_worker;
+            QMetaObject::invokeMethod(w, [w, exe, flow]() {
+                if (w->m_destroying.load())
+                    return;
+                w->noteExecutableSeen(exe);
+                w->scheduleSnapshot(flow);
+            }, Qt::QueuedConnection);
             return S_OK;
         }
 
     private:
         std::atomic<ULONG> m_ref{1};
         AudioWorker *m_worker = nullptr;
+        QString m_deviceId;
     };
 
     ComPtr<IMMNotificationClient> notifyClient;
     ComPtr<IAudioEndpointVolumeCallback> endpointCb;
-    ComPtr<IAudioSessionNotification> sessionCb;
 
     QTimer peakPollTimer;
 
@@ -344,7 +400,6 @@ struct AudioWorker::Impl
         HR_RET(enumerator->RegisterEndpointNotificationCallback(notifyClient.get()));
 
         endpointCb.attach(new EndpointCallback(worker));
-        sessionCb.attach(new SessionNotification(worker));
 
         return S_OK;
     }
@@ -357,8 +412,8 @@ struct AudioWorker::Impl
             if (dc.endpoint && endpointCb) {
                 dc.endpoint->UnregisterControlChangeNotify(endpointCb.get());
             }
-            if (dc.sessionMgr && sessionCb) {
-                dc.sessionMgr->UnregisterSessionNotification(sessionCb.get());
+            if (dc.sessionMgr && dc.sessionCb) {
+                dc.sessionMgr->UnregisterSessionNotification(dc.sessionCb.get());
             }
         }
 
@@ -381,7 +436,6 @@ struct AudioWorker::Impl
         enumerator.reset();
         notifyClient.reset();
         endpointCb.reset();
-        sessionCb.reset();
 
         if (comHr == S_OK || comHr == S_FALSE) {
             CoUninitialize();
@@ -425,6 +479,7 @@ void AudioWorker::start()
 {
     if (!m)
         return;
+    Tracer::setThreadName("audio-worker");
 
     const HRESULT hr = m->init(this);
     if (FAILED(hr)) {
@@ -455,14 +510,82 @@ void AudioWorker::setShowSystemSessions(bool show)
     scheduleSnapshot();
 }
 
-void AudioWorker::setDeviceVolume(const QString &deviceId, double volume01)
+void AudioWorker::setVolumes(const QVector<VolumeTarget> &targets)
 {
     if (m_destroying.load() || !m)
         return;
-    auto it = m->devices.find(deviceId);
-    if (it == m->devices.end() || !it->second.endpoint)
+    writeTargets(targets);
+}
+
+void AudioWorker::applyScene(const QVector<VolumeTarget> &targets, qint64 requestedAtNs, bool measurement)
+{
+    if (m_destroying.load() || !m)
         return;
-    it->second.endpoint->SetMasterVolumeLevelScalar(static_cast<float>(qBound(0.0, volume01, 1.0)), nullptr);
+    const qint64 startNs = Metrics::nowNs();
+    const int written = writeTargets(targets, measurement);
+    const qint64 endNs = Metrics::nowNs();
+    emit sceneApplied(int(targets.size()), written, qMax<qint64>(0, startNs - requestedAtNs), endNs - startNs,
+                      measurement);
+    // Endpoint callbacks cover devices; session levels reach the GUI with the next snapshot.
+    scheduleSnapshot();
+}
+
+int AudioWorker::writeTargets(const QVector<VolumeTarget> &targets, bool rewriteCurrent)
+{
+    static auto &inputToWrite = Metrics::instance().histogram(QStringLiteral("latency.sliderToComWrite"));
+    const auto noteWritten = [](const VolumeTarget &t) {
+        if (t.requestedAtNs > 0)
+            inputToWrite.record(Metrics::nowNs() - t.requestedAtNs);
+    };
+    const auto writeSession = [rewriteCurrent](Impl::SessionCom &sc, const VolumeTarget &t) {
+        if (!sc.simple)
+            return false;
+        float level = static_cast<float>(qBound(0.0, t.volume, 1.0));
+        BOOL mute = t.muted ? TRUE : FALSE;
+        if (rewriteCurrent && (FAILED(sc.simple->GetMasterVolume(&level)) || FAILED(sc.simple->GetMute(&mute))))
+            return false;
+        sc.simple->SetMasterVolume(level, &kEarieEventContext);
+        if (t.applyMute)
+            sc.simple->SetMute(mute, &kEarieEventContext);
+        return true;
+    };
+
+    int written = 0;
+    // pid 0 targets name an executable, not a session; they are matched in one sweep below.
+    QHash<QString, const VolumeTarget *> byExe;
+    for (const auto &t : targets) {
+        if (t.kind == VolumeTarget::Kind::Device) {
+            auto it = m->devices.find(t.deviceId);
+            if (it == m->devices.end() || !it->second.endpoint)
+                continue;
+            auto *endpoint = it->second.endpoint.Get();
+            float level = static_cast<float>(qBound(0.0, t.volume, 1.0));
+            BOOL mute = t.muted ? TRUE : FALSE;
+            if (rewriteCurrent && (FAILED(endpoint->GetMasterVolumeLevelScalar(&level)) || FAILED(endpoint->GetMute(&mute))))
+                continue;
+            endpoint->SetMasterVolumeLevelScalar(level, &kEarieEventContext);
+            if (t.applyMute)
+                endpoint->SetMute(mute, &kEarieEventContext);
+            noteWritten(t);
+            ++written;
+        } else if (t.pid == 0) {
+            byExe.insert(appVolumeKey(t.deviceId, t.exePath), &t);
+        } else {
+            auto it = m->sessions.find(Impl::SessionKey{t.deviceId, t.pid, t.exePath});
+            if (it != m->sessions.end() && writeSession(it->second, t)) {
+                noteWritten(t);
+                ++written;
+            }
+        }
+    }
+    if (byExe.isEmpty())
+        return written;
+    for (auto &kv : m->sessions) {
+        const VolumeTarget *t = byExe.value(appVolumeKey(kv.first.deviceId, kv.first.exePath), nullptr);
+        if (t && writeSession(kv.second, *t))
+            ++written;
+    }
+    return written;
 }
 
 void AudioWorker::setDeviceMuted(const QString &deviceId, bool muted)
@@ -472,10 +595,10 @@ void AudioWorker::setDeviceMuted(const QString &deviceId, bool muted)
     auto it = m->devices.find(deviceId);
     if (it == m->devices.end() || !it->second.endpoint)
         return;
-    it->second.endpoint->SetMute(muted ? TRUE : FALSE, nullptr);
+    it->second.endpoint->SetMute(muted ? TRUE : FALSE, &kEarieEventContext);
 }
 
-void AudioWorker::setSessionVolume(const QString &deviceId, quint32 pid, const QString &exePath, double volume01)
+void AudioWorker::setSessionMuted(const QString &deviceId, quint32 pid, const QString &exePath, bool muted)
 {
     if (m_destroying.load() || !m)
         return;
@@ -483,27 +606,56 @@ void AudioWorker::setSessionVolume(const QString &deviceId, quint32 pid, const Q
     auto it = m->sessions.find(key);
     if (it == m->sessions.end() || !it->second.simple)
         return;
-    it->second.simple->SetMasterVolume(static_cast<float>(qBound(0.0, volume01, 1.0)), nullptr);
+    it->second.simple->SetMute(muted ? TRUE : FALSE, &kEarieEventContext);
 }
 
-void AudioWorker::setSessionMuted(const QString &deviceId, quint32 pid, const QString &exePath, bool muted)
+void AudioWorker::setAppVolumeTable(const AppVolumeTable &table)
 {
-    if (m_destroying.load() || !m)
-        return;
-    Impl::SessionKey key{deviceId, pid, exePath};
-    auto it = m->sessions.find(key);
-    if (it == m->sessions.end() || !it->second.simple)
+    auto next = table.isEmpty() ? nullptr : std::make_shared<const AppVolumeTable>(table);
+    QMutexLocker lock(&m_appVolumesLock);
+    m_appVolumes = std::move(next);
+}
+
+bool AudioWorker::rememberedVolume(const QString &deviceId, const QString &exePath, AppVolume *out) const
+{
+    std::shared_ptr<const AppVolumeTable> table;
+    {
+        QMutexLocker lock(&m_appVolumesLock);
+        table = m_appVolumes;
+    }
+    if (!table)
+        return false;
+
+    auto it = table->constFind(appVolumeKey(deviceId, exePath));
+    if (it == table->constEnd())
+        it = table->constFind(appVolumeKey(QString(), exePath));
+    if (it == table->constEnd())
+        return false;
+    *out = it.value();
+    return true;
+}
+
+void AudioWorker::noteExecutableSeen(const QString &exePath)
+{
+    if (exePath.isEmpty() || !m_history.noteExecutable(exePath))
         return;
-    it->second.simple->SetMute(muted ? TRUE : FALSE, nullptr);
+    emit executableSeen(exePath);
 }
 
-void AudioWorker::scheduleSnapshot()
+void AudioWorker::scheduleSnapshot(quint64 traceFlow, qint64 changeStampNs)
 {
     // Check if object is being destroyed or already destroyed
     if (m_destroying.load() || !m) {
         qWarning("AudioWorker::scheduleSnapshot() called after destruction - this indicates a race condition with COM callbacks");
         return;
     }
+    if (traceFlow) {
+        Tracer::Span span("worker.scheduleSnapshot");
+        Tracer::flowStep(traceFlow);
+        m_pendingTraceFlows.append(traceFlow);
+    }
+    if (changeStampNs > 0 && m_pendingChangeStamps.size() < kMaxPendingChangeStamps)
+        m_pendingChangeStamps.append(changeStampNs);
     // Additional safety: check if timer is still valid (parent object might be destroyed)
     if (!m_snapshotTimer.isActive() && m_snapshotTimer.parent() == this)
         m_snapshotTimer.start();
@@ -515,10 +667,22 @@ void AudioWorker::emitSnapshotNow()
     if (m_destroying.load() || !m || !m->enumerator)
         return;
 
+    static auto &snapshots = Metrics::instance().counter(QStringLiteral("worker.snapshots"));
+    static auto &snapshotTime = Metrics::instance().histogram(QStringLiteral("worker.snapshot"));
+    static auto &enumErrors = Metrics::instance().counter(QStringLiteral("worker.enumErrors"));
+    Metrics::ScopedTimer timer(snapshotTime);
+    snapshots.add();
+    Tracer::Span span("worker.enumerate");
+    // Every change coalesced into this snapshot ends here; one new flow carries the snapshot on.
+    for (const quint64 flow : std::as_const(m_pendingTraceFlows))
+        Tracer::flowEnd(flow);
+    m_pendingTraceFlows.clear();
+
     // Refresh device list.
     ComPtr<IMMDeviceCollection> coll;
     HRESULT hr = m->enumerator->EnumAudioEndpoints(eRender, DEVICE_STATE_ACTIVE, coll.put());
     if (FAILED(hr)) {
+        enumErrors.add();
         emit error(QStringLiteral("EnumAudioEndpoints failed: %1").arg(hrToString(hr)));
         return;
     }
@@ -550,8 +714,8 @@ void AudioWorker::emitSnapshotNow()
             if (dc.endpoint && m->endpointCb) {
                 dc.endpoint->UnregisterControlChangeNotify(m->endpointCb.get());
             }
-            if (dc.sessionMgr && m->sessionCb) {
-                dc.sessionMgr->UnregisterSessionNotification(m->sessionCb.get());
+            if (dc.sessionMgr && dc.sessionCb) {
+                dc.sessionMgr->UnregisterSessionNotification(dc.sessionCb.get());
             }
         }
         for (auto &kv : m->sessions) {
@@ -569,6 +733,8 @@ void AudioWorker::emitSnapshotNow()
     }
 
     const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    // Rebuilt from the sessions present now, so PIDs that came and went do not pile up.
+    m_history.beginPass();
 
     for (UINT i = 0; i < count; ++i) {
         // Check periodically during long-running operation
@@ -616,8 +782,9 @@ void AudioWorker::emitSnapshotNow()
             hr = dc.device->Activate(__uuidof(IAudioSessionManager2), CLSCTX_ALL, nullptr, reinterpret_cast<void **>(mgr.put()));
             if (SUCCEEDED(hr) && mgr) {
                 // Only register callback if not destroying
-                if (!m_destroying.load() && m && m->sessionCb) {
-                    mgr->RegisterSessionNotification(m->sessionCb.get());
+                if (!m_destroying.load() && m) {
+                    dc.sessionCb.attach(new Impl::SessionNotification(this, id));
+                    mgr->RegisterSessionNotification(dc.sessionCb.get());
                 }
                 dc.sessionMgr.attach(mgr.detach());
 
@@ -642,6 +809,7 @@ void AudioWorker::emitSnapshotNow()
                         const QString exe = exePathForPid(pid);
                         if (!m_showSystemSessions && isLikelySystemSession(exe))
                             continue;
+                        noteExecutableSeen(exe);
 
                         // Volume/mute.
                         ComPtr<ISimpleAudioVolume> simple;
@@ -667,12 +835,8 @@ void AudioWorker::emitSnapshotNow()
                         AudioSessionState st = AudioSessionStateInactive;
                         ctrl->GetState(&st);
 
-                        const QString keyStr = id + QLatin1Char('|') + QString::number(pid) + QLatin1Char('|') + exe;
-                        qint64 lastActive = m->lastActiveByKeyStr.value(keyStr, 0);
-                        if (st == AudioSessionStateActive) {
-                            lastActive = nowMs;
-                            m->lastActiveByKeyStr.insert(keyStr, lastActive);
-                        }
+                        const qint64 lastActive = m_history.noteSession(id, static_cast<quint32>(pid), exe,
+                                                                        st == AudioSessionStateActive, nowMs);
 
                         SessionState ss;
                         ss.deviceId = id;
@@ -732,9 +896,26 @@ void AudioWorker::emitSnapshotNow()
         }
     }
 
-    // Only emit if not destroying
+    // Only a complete pass may forget anything.
     if (!m_destroying.load() && m)
-        emit snapshotReady(devices);
+        m_history.commitPass();
+
+    static auto &deviceCount = Metrics::instance().gauge(QStringLiteral("worker.devices"));
+    static auto &sessionCount = Metrics::instance().gauge(QStringLiteral("worker.sessions"));
+    static auto &lastActiveCount = Metrics::instance().gauge(QStringLiteral("worker.lastActiveEntries"));
+    static auto &seenExeCount = Metrics::instance().gauge(QStringLiteral("worker.seenExePaths"));
+    deviceCount.set(devices.size());
+    sessionCount.set(m ? qint64(m->sessions.size()) : 0);
+    lastActiveCount.set(m_history.lastActiveEntries());
+    seenExeCount.set(m_history.seenExecutables());
+
+    // Only emit if not destroying
+    if (!m_destroying.load() && m) {
+        Tracer::Span emitSpan("worker.snapshotReady");
+        const quint64 flow = Tracer::newFlowId();
+        Tracer::flowStart(flow);
+        emit snapshotReady(devices, flow, std::exchange(m_pendingChangeStamps, {}));
+    }
 }
 
 void AudioWorker::emitPeaksNow()
@@ -743,6 +924,9 @@ void AudioWorker::emitPeaksNow()
     if (m_destroying.load() || !m)
         return;
 
+    static auto &pollTime = Metrics::instance().histogram(QStringLiteral("worker.peakPoll"));
+    Metrics::ScopedTimer timer(pollTime);
+
     QVector<SessionPeak> peaks;
     peaks.reserve(static_cast<int>(m->sessions.size()));
 
@@ -1,16 +1,47 @@
 #include "ConfigStore.h"
 
+#include "Metrics.h"
+
+#include <QCoreApplication>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QSaveFile>
 #include <QStandardPaths>
 
+#include <algorithm>
+#include <utility>
+
+// Quiet period before a change is written, and the longest a continuous stream of changes
+// (e.g. dragging a device through the list) may postpone the write.
+static constexpr int kSaveDebounceMs = 400;
+static constexpr int kMaxSaveDelayMs = 2000;
+// Editors and deployment scripts often write a file in several steps; parse once they settle.
+static constexpr int kReloadDebounceMs = 250;
+
 ConfigStore::ConfigStore(QObject *parent)
     : QObject(parent)
 {
-    connect(this, &ConfigStore::changed, this, [this]() { save(); });
+    m_saveDebounce.setSingleShot(true);
+    m_saveDebounce.setInterval(kSaveDebounceMs);
+    m_saveDebounce.setParent(this);
+    connect(&m_saveDebounce, &QTimer::timeout, this, &ConfigStore::writeBehind);
+
+    m_writer.setMaxThreadCount(1);
+    m_writer.setExpiryTimeout(5000);
+
+    connect(this, &ConfigStore::changed, this, &ConfigStore::scheduleSave);
+    if (QCoreApplication::instance())
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &ConfigStore::flush);
+}
+
+ConfigStore::~ConfigStore()
+{
+    flush();
 }
 
 QString ConfigStore::configPath() const
@@ -19,44 +50,39 @@ QString ConfigStore::configPath() const
     return QDir(base).filePath(QStringLiteral("config.json"));
 }
 
-void ConfigStore::load()
+bool ConfigStore::parse(const QByteArray &bytes, Data *out)
 {
-    const QString path = configPath();
-    QFile f(path);
-    if (!f.exists())
-        return;
-    if (!f.open(QIODevice::ReadOnly))
-        return;
-
-    const auto doc = QJsonDocument::fromJson(f.readAll());
+    const auto doc = QJsonDocument::fromJson(bytes);
     if (!doc.isObject())
-        return;
+        return false;
 
     const QJsonObject o = doc.object();
+    Data &d = *out;
 
     const QString modeStr = o.value(QStringLiteral("mode")).toString(QStringLiteral("default"));
-    m_mode = (modeStr == QLatin1String("all")) ? Mode::AllDevices : Mode::DefaultDeviceOnly;
+    d.mode = (modeStr == QLatin1String("all")) ? Mode::AllDevices : Mode::DefaultDeviceOnly;
 
-    m_showSystemSessions = o.value(QStringLiteral("showSystemSessions")).toBool(false);
-    m_showProcessStatusOnHover = o.value(QStringLiteral("showProcessStatusOnHover")).toBool(false);
-    m_scrollWheelVolumeOnHover = o.value(QStringLiteral("scrollWheelVolumeOnHover")).toBool(false);
-    m_startWithWindows = o.value(QStringLiteral("startWithWindows")).toBool(false);
+    d.showSystemSessions = o.value(QStringLiteral("showSystemSessions")).toBool(false);
+    d.showProcessStatusOnHover = o.value(QStringLiteral("showProcessStatusOnHover")).toBool(false);
+    d.scrollWheelVolumeOnHover = o.value(QStringLiteral("scrollWheelVolumeOnHover")).toBool(false);
+    d.startWithWindows = o.value(QStringLiteral("startWithWindows")).toBool(false);
+    d.trayIconStyle = o.value(QStringLiteral("trayIconStyle")).toString(QStringLiteral("buckets"));
 
-    m_hiddenDevices.clear();
+    d.hiddenDevices.clear();
     for (const auto &v : o.value(QStringLiteral("hiddenDevices")).toArray()) {
         const QString id = v.toString();
         if (!id.isEmpty())
-            m_hiddenDevices.insert(id);
+            d.hiddenDevices.insert(id);
     }
 
-    m_hiddenProcessesGlobal.clear();
+    d.hiddenProcessesGlobal.clear();
     for (const auto &v : o.value(QStringLiteral("hiddenProcessesGlobal")).toArray()) {
         const QString exe = v.toString();
         if (!exe.isEmpty())
-            m_hiddenProcessesGlobal.insert(exe);
+            d.hiddenProcessesGlobal.insert(exe);
     }
 
-    m_hiddenProcessesPerDevice.clear();
+    d.hiddenProcessesPerDevice.clear();
     const QJsonObject perDev = o.value(QStringLiteral("hiddenProcessesPerDevice")).toObject();
     for (auto it = perDev.begin(); it != perDev.end(); ++it) {
         const QString devId = it.key();
@@ -67,45 +93,95 @@ void ConfigStore::load()
                 set.insert(exe);
         }
         if (!devId.isEmpty() && !set.isEmpty())
-            m_hiddenProcessesPerDevice.insert(devId, set);
+            d.hiddenProcessesPerDevice.insert(devId, set);
     }
 
-    m_deviceOrder.clear();
+    d.deviceOrder.clear();
     for (const auto &v : o.value(QStringLiteral("deviceOrder")).toArray()) {
         const QString id = v.toString();
         if (!id.isEmpty())
-            m_deviceOrder.append(id);
+            d.deviceOrder.append(id);
+    }
+
+    d.rememberAppVolumes = o.value(QStringLiteral("rememberAppVolumes")).toBool(true);
+    d.rememberAppVolumesPerDevice = o.value(QStringLiteral("rememberAppVolumesPerDevice")).toBool(false);
+    d.appVolumes.clear();
+    const QJsonObject appVolumes = o.value(QStringLiteral("appVolumes")).toObject();
+    for (auto it = appVolumes.begin(); it != appVolumes.end(); ++it) {
+        const QJsonObject e = it.value().toObject();
+        if (it.key().isEmpty() || !e.contains(QStringLiteral("volume")))
+            continue;
+        AppVolume av;
+        av.volume = qBound(0.0, e.value(QStringLiteral("volume")).toDouble(1.0), 1.0);
+        av.muted = e.value(QStringLiteral("muted")).toBool(false);
+        d.appVolumes.insert(it.key(), av);
+    }
+
+    d.scenes.clear();
+    for (const auto &v : o.value(QStringLiteral("scenes")).toArray()) {
+        const QJsonObject so = v.toObject();
+        VolumeScene scene;
+        scene.name = so.value(QStringLiteral("name")).toString().trimmed();
+        if (scene.name.isEmpty())
+            continue;
+        for (const auto &tv : so.value(QStringLiteral("targets")).toArray()) {
+            const QJsonObject to = tv.toObject();
+            VolumeTarget t;
+            t.deviceId = to.value(QStringLiteral("device")).toString();
+            t.exePath = to.value(QStringLiteral("exe")).toString();
+            if (t.deviceId.isEmpty())
+                continue;
+            t.kind = t.exePath.isEmpty() ? VolumeTarget::Kind::Device : VolumeTarget::Kind::Session;
+            t.volume = qBound(0.0, to.value(QStringLiteral("volume")).toDouble(1.0), 1.0);
+            t.applyMute = to.contains(QStringLiteral("muted"));
+            t.muted = to.value(QStringLiteral("muted")).toBool(false);
+            scene.targets.append(t);
+        }
+        d.scenes.append(scene);
     }
+    return true;
 }
 
-void ConfigStore::save() const
+void ConfigStore::load()
 {
-    const QString path = configPath();
-    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile f(configPath());
+    if (f.open(QIODevice::ReadOnly)) {
+        const QByteArray bytes = f.readAll();
+        m_fileHash.store(qHash(bytes), std::memory_order_relaxed);
+        Data d;
+        if (parse(bytes, &d))
+            m_d = d;
+    }
+    m_persisted = m_d;
+    watchConfigFile();
+}
 
+QJsonObject ConfigStore::toJson(const Data &d)
+{
     QJsonObject o;
     o.insert(QStringLiteral("schemaVersion"), 1);
-    o.insert(QStringLiteral("mode"), m_mode == Mode::AllDevices ? QStringLiteral("all") : QStringLiteral("default"));
-    o.insert(QStringLiteral("showSystemSessions"), m_showSystemSessions);
-    o.insert(QStringLiteral("showProcessStatusOnHover"), m_showProcessStatusOnHover);
-    o.insert(QStringLiteral("scrollWheelVolumeOnHover"), m_scrollWheelVolumeOnHover);
-    o.insert(QStringLiteral("startWithWindows"), m_startWithWindows);
+    o.insert(QStringLiteral("mode"), d.mode == Mode::AllDevices ? QStringLiteral("all") : QStringLiteral("default"));
+    o.insert(QStringLiteral("showSystemSessions"), d.showSystemSessions);
+    o.insert(QStringLiteral("showProcessStatusOnHover"), d.showProcessStatusOnHover);
+    o.insert(QStringLiteral("scrollWheelVolumeOnHover"), d.scrollWheelVolumeOnHover);
+    o.insert(QStringLiteral("startWithWindows"), d.startWithWindows);
+    o.insert(QStringLiteral("trayIconStyle"), d.trayIconStyle);
 
     {
         QJsonArray arr;
-        for (const auto &id : m_hiddenDevices)
+        for (const auto &id : d.hiddenDevices)
             arr.append(id);
         o.insert(QStringLiteral("hiddenDevices"), arr);
     }
     {
         QJsonArray arr;
-        for (const auto &exe : m_hiddenProcessesGlobal)
+        for (const auto &exe : d.hiddenProcessesGlobal)
             arr.append(exe);
         o.insert(QStringLiteral("hiddenProcessesGlobal"), arr);
     }
     {
         QJsonObject perDev;
-        for (auto it = m_hiddenProcessesPerDevice.begin(); it != m_hiddenProcessesPerDevice.end(); ++it) {
+        for (auto it = d.hiddenProcessesPerDevice.begin(); it != d.hiddenProcessesPerDevice.end(); ++it) {
             QJsonArray arr;
             for (const auto &exe : it.value())
                 arr.append(exe);
@@ -115,112 +191,550 @@ void ConfigStore::save() const
     }
     {
         QJsonArray arr;
-        for (const auto &id : m_deviceOrder)
+        for (const auto &id : d.deviceOrder)
             arr.append(id);
         o.insert(QStringLiteral("deviceOrder"), arr);
     }
 
-    QFile f(path);
-    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    o.insert(QStringLiteral("rememberAppVolumes"), d.rememberAppVolumes);
+    o.insert(QStringLiteral("rememberAppVolumesPerDevice"), d.rememberAppVolumesPerDevice);
+    {
+        QJsonObject appVolumes;
+        for (auto it = d.appVolumes.cbegin(); it != d.appVolumes.cend(); ++it) {
+            QJsonObject e;
+            e.insert(QStringLiteral("volume"), it.value().volume);
+            e.insert(QStringLiteral("muted"), it.value().muted);
+            appVolumes.insert(it.key(), e);
+        }
+        o.insert(QStringLiteral("appVolumes"), appVolumes);
+    }
+    {
+        // Session targets are stored by exe only (no "exe" key = device endpoint).
+        QJsonArray scenes;
+        for (const auto &scene : d.scenes) {
+            QJsonArray targets;
+            for (const auto &t : scene.targets) {
+                QJsonObject e;
+                e.insert(QStringLiteral("device"), t.deviceId);
+                if (t.kind == VolumeTarget::Kind::Session)
+                    e.insert(QStringLiteral("exe"), t.exePath);
+                e.insert(QStringLiteral("volume"), t.volume);
+                if (t.applyMute)
+                    e.insert(QStringLiteral("muted"), t.muted);
+                targets.append(e);
+            }
+            QJsonObject so;
+            so.insert(QStringLiteral("name"), scene.name);
+            so.insert(QStringLiteral("targets"), targets);
+            scenes.append(so);
+        }
+        o.insert(QStringLiteral("scenes"), scenes);
+    }
+    return o;
+}
+
+bool ConfigStore::writeFile(const QString &path, const QByteArray &bytes)
+{
+    static auto &writeTime = Metrics::instance().histogram(QStringLiteral("config.write"));
+    Metrics::ScopedTimer timer(writeTime);
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+    f.write(bytes);
+    return f.commit();
+}
+
+void ConfigStore::save()
+{
+    const QByteArray bytes = QJsonDocument(toJson(m_d)).toJson(QJsonDocument::Indented);
+    m_persisted = m_d;
+    if (writeFile(configPath(), bytes))
+        m_fileHash.store(qHash(bytes), std::memory_order_relaxed);
+}
+
+ConfigStore::Batch::Batch(ConfigStore *store)
+    : m_store(store)
+{
+    if (m_store)
+        m_store->beginBatch();
+}
+
+ConfigStore::Batch::~Batch()
+{
+    if (m_store)
+        m_store->endBatch();
+}
+
+void ConfigStore::beginBatch()
+{
+    ++m_batchDepth;
+}
+
+void ConfigStore::endBatch()
+{
+    if (m_batchDepth <= 0 || --m_batchDepth > 0)
         return;
-    f.write(QJsonDocument(o).toJson(QJsonDocument::Indented));
+    if (m_batchChanges.isEmpty())
+        return;
+    const ChangeSet changes = std::exchange(m_batchChanges, ChangeSet{});
+    emit changed();
+    emit changesCommitted(changes);
 }
 
-void ConfigStore::setMode(Mode m)
+void ConfigStore::noteChange(const ChangeSet &changes)
 {
-    if (m_mode == m)
+    if (m_batchDepth > 0) {
+        if (!m_batchChanges.isEmpty())
+            ++m_notificationsBatched;
+        m_batchChanges.merge(changes);
         return;
-    m_mode = m;
+    }
     emit changed();
+    emit changesCommitted(changes);
+}
+
+void ConfigStore::scheduleSave()
+{
+    // Mutations replayed from an external edit are already on disk.
+    if (m_applyingExternal)
+        return;
+    ++m_savesRequested;
+    if (!m_dirty) {
+        m_dirty = true;
+        m_dirtySince.start();
+    } else {
+        m_savesCoalesced.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (m_dirtySince.elapsed() >= kMaxSaveDelayMs) {
+        writeBehind();
+        return;
+    }
+    m_saveDebounce.start();
+}
+
+void ConfigStore::writeBehind()
+{
+    m_saveDebounce.stop();
+    if (!m_dirty)
+        return;
+    m_dirty = false;
+
+    m_persisted = m_d;
+    const quint64 gen = m_saveGeneration.fetch_add(1, std::memory_order_relaxed) + 1;
+    m_writer.start([this, snapshot = m_d, path = configPath(), gen]() {
+        // A newer snapshot is already queued behind this one; it supersedes this write.
+        if (gen != m_saveGeneration.load(std::memory_order_relaxed)) {
+            m_writesSuperseded.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        const QByteArray bytes = QJsonDocument(toJson(snapshot)).toJson(QJsonDocument::Indented);
+        if (writeFile(path, bytes)) {
+            // Lets the hot-reload path recognize (and ignore) the watcher event for our own write.
+            m_fileHash.store(qHash(bytes), std::memory_order_relaxed);
+            m_savesWritten.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            m_saveFailures.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+}
+
+void ConfigStore::flush()
+{
+    writeBehind();
+    m_writer.waitForDone();
+}
+
+void ConfigStore::watchConfigFile()
+{
+    if (!m_watcher) {
+        m_watcher = new QFileSystemWatcher(this);
+        m_reloadDebounce.setSingleShot(true);
+        m_reloadDebounce.setInterval(kReloadDebounceMs);
+        m_reloadDebounce.setParent(this);
+        connect(&m_reloadDebounce, &QTimer::timeout, this, &ConfigStore::reloadInBackground);
+        // Atomic replaces (ours via QSaveFile, or an editor's) drop the file from the watch list;
+        // the directory watch notices the new file so it can be re-added.
+        connect(m_watcher, &QFileSystemWatcher::fileChanged, this, [this]() {
+            watchConfigFile();
+            m_reloadDebounce.start();
+        });
+        connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+            if (!m_watcher->files().contains(configPath()) && QFileInfo::exists(configPath())) {
+                watchConfigFile();
+                m_reloadDebounce.start();
+            }
+        });
+    }
+
+    const QString path = configPath();
+    const QString dir = QFileInfo(path).absolutePath();
+    QDir().mkpath(dir);
+    if (!m_watcher->directories().contains(dir))
+        m_watcher->addPath(dir);
+    if (QFileInfo::exists(path) && !m_watcher->files().contains(path))
+        m_watcher->addPath(path);
+}
+
+void ConfigStore::reloadInBackground()
+{
+    // Same single thread as the writes, so a reload never reads a file we are still writing.
+    m_writer.start([this, path = configPath()]() {
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly))
+            return;
+        const QByteArray bytes = f.readAll();
+        const size_t hash = qHash(bytes);
+        if (hash == m_fileHash.load(std::memory_order_relaxed))
+            return; // our own write, or touched without a content change
+        Data parsed;
+        if (!parse(bytes, &parsed))
+            return; // mid-edit or malformed; wait for the next change
+        m_fileHash.store(hash, std::memory_order_relaxed);
+        QMetaObject::invokeMethod(this, [this, parsed]() { applyExternal(parsed); }, Qt::QueuedConnection);
+    });
+}
+
+template <typename T>
+static void symmetricDiff(const QSet<T> &a, const QSet<T> &b, QSet<T> *out)
+{
+    for (const auto &v : a) {
+        if (!b.contains(v))
+            out->insert(v);
+    }
+    for (const auto &v : b) {
+        if (!a.contains(v))
+            out->insert(v);
+    }
+}
+
+ConfigStore::ChangeSet ConfigStore::diff(const Data &a, const Data &b)
+{
+    ChangeSet cs;
+    if (a.mode != b.mode)
+        cs.fields |= ChangeSet::ModeField;
+    if (a.showSystemSessions != b.showSystemSessions)
+        cs.fields |= ChangeSet::ShowSystemSessionsField;
+    if (a.showProcessStatusOnHover != b.showProcessStatusOnHover)
+        cs.fields |= ChangeSet::ShowProcessStatusOnHoverField;
+    if (a.scrollWheelVolumeOnHover != b.scrollWheelVolumeOnHover)
+        cs.fields |= ChangeSet::ScrollWheelVolumeOnHoverField;
+    if (a.startWithWindows != b.startWithWindows)
+        cs.fields |= ChangeSet::StartWithWindowsField;
+    if (a.trayIconStyle != b.trayIconStyle)
+        cs.fields |= ChangeSet::TrayIconStyleField;
+    if (a.deviceOrder != b.deviceOrder)
+        cs.fields |= ChangeSet::DeviceOrderField;
+    if (a.rememberAppVolumes != b.rememberAppVolumes || a.rememberAppVolumesPerDevice != b.rememberAppVolumesPerDevice)
+        cs.fields |= ChangeSet::RememberAppVolumesField;
+    if (a.appVolumes != b.appVolumes)
+        cs.fields |= ChangeSet::AppVolumesField;
+    if (a.scenes != b.scenes)
+        cs.fields |= ChangeSet::ScenesField;
+
+    QSet<QString> devices;
+    symmetricDiff(a.hiddenDevices, b.hiddenDevices, &devices);
+    if (!devices.isEmpty()) {
+        cs.fields |= ChangeSet::HiddenDevicesField;
+        cs.deviceIds.unite(devices);
+    }
+
+    QSet<QString> exes;
+    symmetricDiff(a.hiddenProcessesGlobal, b.hiddenProcessesGlobal, &exes);
+    if (!exes.isEmpty()) {
+        cs.fields |= ChangeSet::HiddenProcessesGlobalField;
+        cs.exePaths.unite(exes);
+    }
+
+    QSet<QString> perDeviceIds;
+    for (auto it = a.hiddenProcessesPerDevice.cbegin(); it != a.hiddenProcessesPerDevice.cend(); ++it)
+        perDeviceIds.insert(it.key());
+    for (auto it = b.hiddenProcessesPerDevice.cbegin(); it != b.hiddenProcessesPerDevice.cend(); ++it)
+        perDeviceIds.insert(it.key());
+    for (const auto &id : std::as_const(perDeviceIds)) {
+        QSet<QString> changed;
+        symmetricDiff(a.hiddenProcessesPerDevice.value(id), b.hiddenProcessesPerDevice.value(id), &changed);
+        if (changed.isEmpty())
+            continue;
+        cs.fields |= ChangeSet::HiddenProcessesPerDeviceField;
+        cs.deviceIds.insert(id);
+        cs.exePaths.unite(changed);
+    }
+    return cs;
+}
+
+void ConfigStore::applyExternal(const Data &ext)
+{
+    // Three-way: only what changed on disk since we last read or wrote it is applied, so local
+    // edits still waiting for the debounced save are not reverted.
+    const Data base = std::exchange(m_persisted, ext);
+    const ChangeSet cs = diff(base, ext);
+    if (cs.isEmpty())
+        return;
+    ++m_externalReloads;
+
+    m_applyingExternal = true;
+    {
+        Batch batch(this);
+        if (cs.has(ChangeSet::ModeField))
+            setMode(ext.mode);
+        if (cs.has(ChangeSet::ShowSystemSessionsField))
+            setShowSystemSessions(ext.showSystemSessions);
+        if (cs.has(ChangeSet::ShowProcessStatusOnHoverField))
+            setShowProcessStatusOnHover(ext.showProcessStatusOnHover);
+        if (cs.has(ChangeSet::ScrollWheelVolumeOnHoverField))
+            setScrollWheelVolumeOnHover(ext.scrollWheelVolumeOnHover);
+        if (cs.has(ChangeSet::StartWithWindowsField))
+            setStartWithWindows(ext.startWithWindows);
+        if (cs.has(ChangeSet::TrayIconStyleField))
+            setTrayIconStyle(ext.trayIconStyle);
+        if (cs.has(ChangeSet::DeviceOrderField))
+            setDeviceOrder(ext.deviceOrder);
+        if (cs.has(ChangeSet::RememberAppVolumesField)) {
+            setRememberAppVolumes(ext.rememberAppVolumes);
+            setRememberAppVolumesPerDevice(ext.rememberAppVolumesPerDevice);
+        }
+        if (cs.has(ChangeSet::AppVolumesField)) {
+            // Per key, like the hidden rules: levels remembered since the last save survive.
+            bool changed = false;
+            const auto applyKey = [&](const QString &key) {
+                const auto before = base.appVolumes.constFind(key);
+                const auto after = ext.appVolumes.constFind(key);
+                const bool inBase = before != base.appVolumes.constEnd();
+                const bool inExt = after != ext.appVolumes.constEnd();
+                if (inBase == inExt && (!inExt || *before == *after))
+                    return;
+                if (inExt)
+                    m_d.appVolumes.insert(key, *after);
+                else
+                    m_d.appVolumes.remove(key);
+                changed = true;
+            };
+            for (auto it = ext.appVolumes.constBegin(); it != ext.appVolumes.constEnd(); ++it)
+                applyKey(it.key());
+            for (auto it = base.appVolumes.constBegin(); it != base.appVolumes.constEnd(); ++it) {
+                if (!ext.appVolumes.contains(it.key()))
+                    applyKey(it.key());
+            }
+            if (changed)
+                noteChange(ChangeSet::AppVolumesField);
+        }
+        if (cs.has(ChangeSet::ScenesField)) {
+            // Per name, like the app volumes: scenes saved or removed since the last save survive.
+            const auto findScene = [](const VolumeSceneList &list, const QString &name) -> const VolumeScene * {
+                for (const auto &s : list) {
+                    if (s.name == name)
+                        return &s;
+                }
+                return nullptr;
+            };
+            for (const auto &scene : ext.scenes) {
+                const VolumeScene *before = findScene(base.scenes, scene.name);
+                if (!before || *before != scene)
+                    saveScene(scene);
+            }
+            for (const auto &scene : base.scenes) {
+                if (!findScene(ext.scenes, scene.name))
+                    removeScene(scene.name);
+            }
+        }
+
+        if (cs.has(ChangeSet::HiddenDevicesField)) {
+            for (const auto &id : cs.deviceIds) {
+                if (base.hiddenDevices.contains(id) != ext.hiddenDevices.contains(id))
+                    setDeviceHidden(id, ext.hiddenDevices.contains(id));
+            }
+        }
+        if (cs.has(ChangeSet::HiddenProcessesGlobalField)) {
+            for (const auto &exe : cs.exePaths) {
+                if (base.hiddenProcessesGlobal.contains(exe) != ext.hiddenProcessesGlobal.contains(exe))
+                    setProcessHiddenGlobal(exe, ext.hiddenProcessesGlobal.contains(exe));
+            }
+        }
+        if (cs.has(ChangeSet::HiddenProcessesPerDeviceField)) {
+            for (const auto &id : cs.deviceIds) {
+                const QSet<QString> before = base.hiddenProcessesPerDevice.value(id);
+                const QSet<QString> after = ext.hiddenProcessesPerDevice.value(id);
+                for (const auto &exe : cs.exePaths) {
+                    if (before.contains(exe) != after.contains(exe))
+                        setProcessHiddenForDevice(id, exe, after.contains(exe));
+                }
+            }
+        }
+    }
+    m_applyingExternal = false;
+}
+
+QVariantMap ConfigStore::saveStats() const
+{
+    QVariantMap out;
+    out.insert(QStringLiteral("savesRequested"), m_savesRequested);
+    out.insert(QStringLiteral("savesWritten"), m_savesWritten.load(std::memory_order_relaxed));
+    out.insert(QStringLiteral("savesCoalesced"), m_savesCoalesced.load(std::memory_order_relaxed));
+    out.insert(QStringLiteral("writesSuperseded"), m_writesSuperseded.load(std::memory_order_relaxed));
+    out.insert(QStringLiteral("saveFailures"), m_saveFailures.load(std::memory_order_relaxed));
+    out.insert(QStringLiteral("notificationsBatched"), m_notificationsBatched);
+    out.insert(QStringLiteral("externalReloads"), m_externalReloads);
+    return out;
+}
+
+void ConfigStore::setMode(Mode m)
+{
+    if (m_d.mode == m)
+        return;
+    m_d.mode = m;
+    noteChange(ChangeSet::ModeField);
 }
 
 void ConfigStore::setShowSystemSessions(bool v)
 {
-    if (m_showSystemSessions == v)
+    if (m_d.showSystemSessions == v)
         return;
-    m_showSystemSessions = v;
-    emit changed();
+    m_d.showSystemSessions = v;
+    noteChange(ChangeSet::ShowSystemSessionsField);
 }
 
 void ConfigStore::setShowProcessStatusOnHover(bool v)
 {
-    if (m_showProcessStatusOnHover == v)
+    if (m_d.showProcessStatusOnHover == v)
         return;
-    m_showProcessStatusOnHover = v;
-    emit changed();
+    m_d.showProcessStatusOnHover = v;
+    noteChange(ChangeSet::ShowProcessStatusOnHoverField);
 }
 
 void ConfigStore::setScrollWheelVolumeOnHover(bool v)
 {
-    if (m_scrollWheelVolumeOnHover == v)
+    if (m_d.scrollWheelVolumeOnHover == v)
         return;
-    m_scrollWheelVolumeOnHover = v;
-    emit changed();
+    m_d.scrollWheelVolumeOnHover = v;
+    noteChange(ChangeSet::ScrollWheelVolumeOnHoverField);
 }
 
 void ConfigStore::setStartWithWindows(bool v)
 {
-    if (m_startWithWindows == v)
+    if (m_d.startWithWindows == v)
         return;
-    m_startWithWindows = v;
-    emit changed();
+    m_d.startWithWindows = v;
+    noteChange(ChangeSet::StartWithWindowsField);
+}
+
+void ConfigStore::setTrayIconStyle(const QString &style)
+{
+    if (m_d.trayIconStyle == style)
+        return;
+    m_d.trayIconStyle = style;
+    noteChange(ChangeSet::TrayIconStyleField);
 }
 
 bool ConfigStore::isDeviceHidden(const QString &deviceId) const
 {
-    return m_hiddenDevices.contains(deviceId);
+    return m_d.hiddenDevices.contains(deviceId);
 }
 
 QStringList ConfigStore::hiddenDevices() const
 {
-    return QStringList(m_hiddenDevices.begin(), m_hiddenDevices.end());
+    return QStringList(m_d.hiddenDevices.begin(), m_d.hiddenDevices.end());
 }
 
 void ConfigStore::setDeviceHidden(const QString &deviceId, bool hidden)
 {
     if (deviceId.isEmpty())
         return;
-    const bool had = m_hiddenDevices.contains(deviceId);
+    const bool had = m_d.hiddenDevices.contains(deviceId);
     if (hidden == had)
         return;
     if (hidden)
-        m_hiddenDevices.insert(deviceId);
+        m_d.hiddenDevices.insert(deviceId);
     else
-        m_hiddenDevices.remove(deviceId);
-    emit changed();
+        m_d.hiddenDevices.remove(deviceId);
+    noteChange(ChangeSet{ChangeSet::HiddenDevicesField, {deviceId}, {}});
 }
 
 void ConfigStore::setDeviceOrder(const QStringList &order)
 {
-    if (m_deviceOrder == order)
+    if (m_d.deviceOrder == order)
         return;
-    m_deviceOrder = order;
-    emit changed();
+    m_d.deviceOrder = order;
+    noteChange(ChangeSet::DeviceOrderField);
+}
+
+void ConfigStore::setRememberAppVolumes(bool v)
+{
+    if (m_d.rememberAppVolumes == v)
+        return;
+    m_d.rememberAppVolumes = v;
+    noteChange(ChangeSet::RememberAppVolumesField);
+}
+
+void ConfigStore::setRememberAppVolumesPerDevice(bool v)
+{
+    if (m_d.rememberAppVolumesPerDevice == v)
+        return;
+    m_d.rememberAppVolumesPerDevice = v;
+    noteChange(ChangeSet::RememberAppVolumesField);
+}
+
+void ConfigStore::rememberAppVolume(const QString &deviceId, const QString &exePath, double volume01, bool muted)
+{
+    if (!m_d.rememberAppVolumes || exePath.isEmpty())
+        return;
+    const QString key = appVolumeKey(m_d.rememberAppVolumesPerDevice ? deviceId : QString(), exePath);
+    const AppVolume av{qBound(0.0, volume01, 1.0), muted};
+    auto it = m_d.appVolumes.find(key);
+    if (it != m_d.appVolumes.end() && it.value() == av)
+        return;
+    m_d.appVolumes.insert(key, av);
+    noteChange(ChangeSet::AppVolumesField);
+}
+
+void ConfigStore::saveScene(const VolumeScene &scene)
+{
+    if (scene.name.isEmpty())
+        return;
+    auto it = std::find_if(m_d.scenes.begin(), m_d.scenes.end(), [&](const VolumeScene &s) { return s.name == scene.name; });
+    if (it == m_d.scenes.end()) {
+        m_d.scenes.append(scene);
+    } else {
+        if (*it == scene)
+            return;
+        *it = scene;
+    }
+    noteChange(ChangeSet::ScenesField);
+}
+
+void ConfigStore::removeScene(const QString &name)
+{
+    const auto removed = m_d.scenes.removeIf([&](const VolumeScene &s) { return s.name == name; });
+    if (removed == 0)
+        return;
+    noteChange(ChangeSet::ScenesField);
 }
 
 bool ConfigStore::isProcessHiddenGlobal(const QString &exePath) const
 {
-    return m_hiddenProcessesGlobal.contains(exePath);
+    return m_d.hiddenProcessesGlobal.contains(exePath);
 }
 
 void ConfigStore::setProcessHiddenGlobal(const QString &exePath, bool hidden)
 {
     if (exePath.isEmpty())
         return;
-    const bool had = m_hiddenProcessesGlobal.contains(exePath);
+    const bool had = m_d.hiddenProcessesGlobal.contains(exePath);
     if (hidden == had)
         return;
     if (hidden)
-        m_hiddenProcessesGlobal.insert(exePath);
+        m_d.hiddenProcessesGlobal.insert(exePath);
     else
-        m_hiddenProcessesGlobal.remove(exePath);
-    emit changed();
+        m_d.hiddenProcessesGlobal.remove(exePath);
+    noteChange(ChangeSet{ChangeSet::HiddenProcessesGlobalField, {}, {exePath}});
 }
 
 bool ConfigStore::isProcessHiddenForDevice(const QString &deviceId, const QString &exePath) const
 {
-    auto it = m_hiddenProcessesPerDevice.constFind(deviceId);
-    if (it == m_hiddenProcessesPerDevice.constEnd())
+    auto it = m_d.hiddenProcessesPerDevice.constFind(deviceId);
+    if (it == m_d.hiddenProcessesPerDevice.constEnd())
         return false;
     return it.value().contains(exePath);
 }
@@ -230,7 +744,7 @@ void ConfigStore::setProcessHiddenForDevice(const QString &deviceId, const QStri
     if (deviceId.isEmpty() || exePath.isEmpty())
         return;
 
-    auto set = m_hiddenProcessesPerDevice.value(deviceId);
+    auto set = m_d.hiddenProcessesPerDevice.value(deviceId);
     const bool had = set.contains(exePath);
     if (hidden == had)
         return;
@@ -240,11 +754,11 @@ void ConfigStore::setProcessHiddenForDevice(const QString &deviceId, const QStri
         set.remove(exePath);
 
     if (set.isEmpty())
-        m_hiddenProcessesPerDevice.remove(deviceId);
+        m_d.hiddenProcessesPerDevice.remove(deviceId);
     else
-        m_hiddenProcessesPerDevice.insert(deviceId, set);
+        m_d.hiddenProcessesPerDevice.insert(deviceId, set);
 
-    emit changed();
+    noteChange(ChangeSet{ChangeSet::HiddenProcessesPerDeviceField, {deviceId}, {exePath}});
 }
 
 
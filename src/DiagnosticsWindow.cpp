@@ -0,0 +1,120 @@
+#include "DiagnosticsWindow.h"
+
+#include "Metrics.h"
+#include "Tracer.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QDateTime>
+#include <QDir>
+#include <QFileDialog>
+#include <QFontDatabase>
+#include <QHBoxLayout>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QSaveFile>
+#include <QScrollBar>
+#include <QStandardPaths>
+#include <QVBoxLayout>
+
+DiagnosticsWindow::DiagnosticsWindow(QWidget *parent)
+    : QWidget(parent, Qt::Window)
+{
+    setWindowTitle(tr("Earie diagnostics"));
+    resize(560, 640);
+
+    m_text = new QPlainTextEdit(this);
+    m_text->setReadOnly(true);
+    m_text->setLineWrapMode(QPlainTextEdit::NoWrap);
+    m_text->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    auto *copy = new QPushButton(tr("Copy JSON"), this);
+    connect(copy, &QPushButton::clicked, this, []() {
+        QApplication::clipboard()->setText(QString::fromUtf8(Metrics::instance().toJson()));
+    });
+    auto *exportButton = new QPushButton(tr("Export JSON…"), this);
+    connect(exportButton, &QPushButton::clicked, this, &DiagnosticsWindow::exportJson);
+    auto *reset = new QPushButton(tr("Reset histograms"), this);
+    connect(reset, &QPushButton::clicked, this, [this]() {
+        Metrics::instance().resetHistograms();
+        refresh();
+    });
+
+    m_traceButton = new QPushButton(this);
+    connect(m_traceButton, &QPushButton::clicked, this, &DiagnosticsWindow::toggleTrace);
+    syncTraceButton();
+
+    auto *buttons = new QHBoxLayout;
+    buttons->addWidget(copy);
+    buttons->addWidget(exportButton);
+    buttons->addStretch();
+    buttons->addWidget(m_traceButton);
+    buttons->addWidget(reset);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->addWidget(m_text);
+    layout->addLayout(buttons);
+
+    m_refresh.setInterval(1000);
+    m_refresh.setParent(this);
+    connect(&m_refresh, &QTimer::timeout, this, &DiagnosticsWindow::refresh);
+}
+
+void DiagnosticsWindow::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    syncTraceButton();
+    refresh();
+    m_refresh.start();
+}
+
+void DiagnosticsWindow::hideEvent(QHideEvent *event)
+{
+    m_refresh.stop();
+    QWidget::hideEvent(event);
+}
+
+void DiagnosticsWindow::toggleTrace()
+{
+    if (!Tracer::enabled()) {
+        Tracer::start();
+        syncTraceButton();
+        return;
+    }
+    Tracer::stop();
+    syncTraceButton();
+    const QString suggested = QDir(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation))
+                                  .filePath(QStringLiteral("earie-trace-%1.json")
+                                                .arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-HHmmss"))));
+    const QString path = QFileDialog::getSaveFileName(this, tr("Save trace"), suggested, tr("Chrome trace (*.json)"));
+    if (!path.isEmpty())
+        Tracer::saveTo(path);
+}
+
+void DiagnosticsWindow::syncTraceButton()
+{
+    m_traceButton->setText(Tracer::enabled() ? tr("Stop trace and save…") : tr("Start trace"));
+}
+
+void DiagnosticsWindow::refresh()
+{
+    // Keep the reader's place across refreshes.
+    const int scroll = m_text->verticalScrollBar()->value();
+    m_text->setPlainText(QString::fromUtf8(Metrics::instance().toJson()));
+    m_text->verticalScrollBar()->setValue(scroll);
+}
+
+void DiagnosticsWindow::exportJson()
+{
+    const QString suggested = QDir(QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation))
+                                  .filePath(QStringLiteral("earie-metrics-%1.json")
+                                                .arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-HHmmss"))));
+    const QString path = QFileDialog::getSaveFileName(this, tr("Export metrics"), suggested, tr("JSON (*.json)"));
+    if (path.isEmpty())
+        return;
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly))
+        return;
+    f.write(Metrics::instance().toJson());
+    f.commit();
+}
@@ -0,0 +1,161 @@
+#include "HiddenItemsModels.h"
+
+HiddenDeviceListModel::HiddenDeviceListModel(QObject *parent)
+    : KeyedListModel<HiddenDeviceEntry>(parent)
+{
+}
+
+QVariant HiddenDeviceListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_rows.size())
+        return {};
+    const auto &r = m_rows.at(index.row());
+
+    switch (role) {
+    case DeviceIdRole: return r.deviceId;
+    case NameRole: return r.name;
+    case ConnectedRole: return r.connected;
+    case HiddenRole: return r.hidden;
+    default: return {};
+    }
+}
+
+QHash<int, QByteArray> HiddenDeviceListModel::roleNames() const
+{
+    return {
+        { DeviceIdRole, "deviceId" },
+        { NameRole, "name" },
+        { ConnectedRole, "connected" },
+        { HiddenRole, "hidden" }
+    };
+}
+
+QVector<int> HiddenDeviceListModel::updateRow(HiddenDeviceEntry &row, const HiddenDeviceEntry &next)
+{
+    QVector<int> roles;
+    if (row.name != next.name) {
+        row.name = next.name;
+        roles.append(NameRole);
+    }
+    if (row.connected != next.connected) {
+        row.connected = next.connected;
+        roles.append(ConnectedRole);
+    }
+    if (row.hidden != next.hidden) {
+        row.hidden = next.hidden;
+        roles.append(HiddenRole);
+    }
+    return roles;
+}
+
+HiddenProcessListModel::HiddenProcessListModel(QObject *parent)
+    : KeyedListModel<HiddenProcessEntry>(parent)
+{
+}
+
+QVariant HiddenProcessListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_rows.size())
+        return {};
+    const auto &r = m_rows.at(index.row());
+
+    switch (role) {
+    case ExePathRole: return r.exePath;
+    case NameRole: return r.name;
+    case HiddenRole: return r.hidden;
+    default: return {};
+    }
+}
+
+QHash<int, QByteArray> HiddenProcessListModel::roleNames() const
+{
+    return {
+        { ExePathRole, "exePath" },
+        { NameRole, "name" },
+        { HiddenRole, "hidden" }
+    };
+}
+
+QVector<int> HiddenProcessListModel::updateRow(HiddenProcessEntry &row, const HiddenProcessEntry &next)
+{
+    QVector<int> roles;
+    if (row.name != next.name) {
+        row.name = next.name;
+        roles.append(NameRole);
+    }
+    if (row.hidden != next.hidden) {
+        row.hidden = next.hidden;
+        roles.append(HiddenRole);
+    }
+    return roles;
+}
+
+HiddenPerDeviceListModel::HiddenPerDeviceListModel(QObject *parent)
+    : KeyedListModel<HiddenDeviceProcessesEntry>(parent)
+{
+}
+
+QVariant HiddenPerDeviceListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_rows.size())
+        return {};
+    const auto &r = m_rows.at(index.row());
+
+    switch (role) {
+    case DeviceIdRole: return r.deviceId;
+    case NameRole: return r.name;
+    case ConnectedRole: return r.connected;
+    case ProcessCountRole: return r.processesModel ? r.processesModel->rowCount() : 0;
+    case ProcessesModelRole: return QVariant::fromValue(static_cast<QObject *>(r.processesModel));
+    default: return {};
+    }
+}
+
+QHash<int, QByteArray> HiddenPerDeviceListModel::roleNames() const
+{
+    return {
+        { DeviceIdRole, "deviceId" },
+        { NameRole, "name" },
+        { ConnectedRole, "connected" },
+        { ProcessCountRole, "processCount" },
+        { ProcessesModelRole, "processesModel" }
+    };
+}
+
+QVector<int> HiddenPerDeviceListModel::updateRow(HiddenDeviceProcessesEntry &row, const HiddenDeviceProcessesEntry &next)
+{
+    QVector<int> roles;
+    if (row.name != next.name) {
+        row.name = next.name;
+        roles.append(NameRole);
+    }
+    if (row.connected != next.connected) {
+        row.connected = next.connected;
+        roles.append(ConnectedRole);
+    }
+
+    // The nested model diffs its own rows; only the count is surfaced on this row.
+    const int before = row.processesModel ? row.processesModel->rowCount() : 0;
+    if (row.processesModel)
+        row.processesModel->sync(next.processes);
+    const int after = row.processesModel ? row.processesModel->rowCount() : 0;
+    if (before != after)
+        roles.append(ProcessCountRole);
+    return roles;
+}
+
+void HiddenPerDeviceListModel::prepareRow(HiddenDeviceProcessesEntry &row)
+{
+    row.processesModel = new HiddenProcessListModel(this);
+    row.processesModel->sync(row.processes);
+    row.processes.clear(); // the nested model is the source of truth from here on
+}
+
+void HiddenPerDeviceListModel::releaseRow(HiddenDeviceProcessesEntry &row)
+{
+    if (row.processesModel) {
+        // QML may still reference it until the removed delegate is torn down.
+        row.processesModel->deleteLater();
+        row.processesModel = nullptr;
+    }
+}
@@ -0,0 +1,211 @@
+#include "HiddenRuleMatcher.h"
+
+#include <QStringList>
+
+static bool hasWildcard(const QString &s)
+{
+    for (const QChar c : s) {
+        if (c == QLatin1Char('*') || c == QLatin1Char('?') || c == QLatin1Char('['))
+            return true;
+    }
+    return false;
+}
+
+// All valid globs of one kind become a single alternation, so a lookup is one regex run, not
+// one per rule. Each glob is checked on its own first: one bad rule must not disable the rest.
+static QRegularExpression combineGlobs(const QStringList &globs, QRegularExpression::WildcardConversionOptions options,
+                                       int *invalid)
+{
+    if (globs.isEmpty())
+        return {};
+    QStringList parts;
+    parts.reserve(globs.size());
+    for (const auto &g : globs) {
+        const QString part = QRegularExpression::wildcardToRegularExpression(
+            g, options | QRegularExpression::UnanchoredWildcardConversion);
+        if (!QRegularExpression(part).isValid()) {
+            ++*invalid;
+            continue;
+        }
+        parts.append(part);
+    }
+    if (parts.isEmpty())
+        return {};
+    QRegularExpression re(QStringLiteral("\\A(?:%1)\\z").arg(parts.join(QLatin1Char('|'))));
+    re.optimize();
+    return re;
+}
+
+QString HiddenRuleMatcher::normalize(const QString &path)
+{
+    QString out = path.trimmed().toCaseFolded();
+    out.replace(QLatin1Char('\\'), QLatin1Char('/'));
+    return out;
+}
+
+QString HiddenRuleMatcher::baseName(const QString &normalizedPath)
+{
+    const int slash = normalizedPath.lastIndexOf(QLatin1Char('/'));
+    return slash < 0 ? normalizedPath : normalizedPath.mid(slash + 1);
+}
+
+bool HiddenRuleMatcher::isExactRule(const QString &rule)
+{
+    const QString n = normalize(rule);
+    return !n.isEmpty() && !hasWildcard(n) && !n.endsWith(QLatin1Char('/')) && n.contains(QLatin1Char('/'));
+}
+
+void HiddenRuleMatcher::RuleSet::add(const QString &rule)
+{
+    const QString n = normalize(rule);
+    if (n.isEmpty())
+        return;
+    m_empty = false;
+
+    if (hasWildcard(n)) {
+        if (n.contains(QLatin1Char('/')))
+            m_pathGlobs.append(n);
+        else
+            m_nameGlobs.append(n);
+        return;
+    }
+    if (n.endsWith(QLatin1Char('/'))) {
+        int node = 0;
+        const auto parts = QStringView(n).split(QLatin1Char('/'), Qt::SkipEmptyParts);
+        for (const auto part : parts) {
+            const QString key = part.toString();
+            const int next = m_trie[node].children.value(key, -1);
+            if (next >= 0) {
+                node = next;
+                continue;
+            }
+            m_trie.push_back(TrieNode{});
+            const int created = int(m_trie.size()) - 1;
+            m_trie[node].children.insert(key, created);
+            node = created;
+        }
+        m_trie[node].terminal = true;
+        return;
+    }
+    if (!n.contains(QLatin1Char('/')))
+        m_basenames.insert(n);
+    else
+        m_exact.insert(n);
+}
+
+void HiddenRuleMatcher::RuleSet::finalize()
+{
+    // A path glob's * and ? stop at a separator (C:/games/*/*.exe is one level deep); a basename
+    // glob only ever sees the file name.
+    m_invalidGlobs = 0;
+    m_pathGlob = combineGlobs(m_pathGlobs, QRegularExpression::DefaultWildcardConversion, &m_invalidGlobs);
+    m_nameGlob = combineGlobs(m_nameGlobs, QRegularExpression::NonPathWildcardConversion, &m_invalidGlobs);
+    m_pathGlobs.clear();
+    m_nameGlobs.clear();
+}
+
+bool HiddenRuleMatcher::RuleSet::underPrefix(const QString &normalizedPath) const
+{
+    if (m_trie.size() <= 1)
+        return false;
+    int node = 0;
+    const auto parts = QStringView(normalizedPath).split(QLatin1Char('/'), Qt::SkipEmptyParts);
+    // The last component is the file itself; a directory rule has to match strictly above it.
+    for (qsizetype i = 0; i + 1 < parts.size(); ++i) {
+        node = m_trie[node].children.value(parts.at(i).toString(), -1);
+        if (node < 0)
+            return false;
+        if (m_trie[node].terminal)
+            return true;
+    }
+    return false;
+}
+
+bool HiddenRuleMatcher::RuleSet::matchUncached(const QString &normalizedPath) const
+{
+    if (m_exact.contains(normalizedPath))
+        return true;
+    const QString name = baseName(normalizedPath);
+    if (m_basenames.contains(name))
+        return true;
+    if (underPrefix(normalizedPath))
+        return true;
+    if (!m_pathGlob.pattern().isEmpty() && m_pathGlob.match(normalizedPath).hasMatch())
+        return true;
+    if (!m_nameGlob.pattern().isEmpty() && m_nameGlob.match(name).hasMatch())
+        return true;
+    return false;
+}
+
+bool HiddenRuleMatcher::RuleSet::matches(const QString &exePath) const
+{
+    if (m_empty || exePath.isEmpty())
+        return false;
+    auto it = m_verdicts.constFind(exePath);
+    if (it != m_verdicts.constEnd()) {
+        ++hits;
+        return it.value();
+    }
+    ++misses;
+    const bool hidden = matchUncached(normalize(exePath));
+    // Self-updating apps put a version in their path, so the set of paths seen never stops
+    // growing; start over rather than keep every one.
+    if (m_verdicts.size() >= kMaxCachedVerdicts)
+        m_verdicts.clear();
+    m_verdicts.insert(exePath, hidden);
+    return hidden;
+}
+
+void HiddenRuleMatcher::compile(const QSet<QString> &global, const QHash<QString, QSet<QString>> &perDevice)
+{
+    m_global = RuleSet();
+    m_perDevice.clear();
+    m_ruleCount = 0;
+
+    for (const auto &r : global)
+        m_global.add(r);
+    m_global.finalize();
+    m_ruleCount += global.size();
+
+    for (auto it = perDevice.cbegin(); it != perDevice.cend(); ++it) {
+        RuleSet set;
+        for (const auto &r : it.value())
+            set.add(r);
+        set.finalize();
+        if (set.isEmpty())
+            continue;
+        m_perDevice.insert(it.key(), std::move(set));
+        m_ruleCount += it.value().size();
+    }
+}
+
+bool HiddenRuleMatcher::isHidden(const QString &deviceId, const QString &exePath) const
+{
+    if (m_global.matches(exePath))
+        return true;
+    auto it = m_perDevice.constFind(deviceId);
+    return it != m_perDevice.constEnd() && it.value().matches(exePath);
+}
+
+QVariantMap HiddenRuleMatcher::stats() const
+{
+    quint64 hits = m_global.hits;
+    quint64 misses = m_global.misses;
+    int cached = m_global.cachedVerdicts();
+    int invalid = m_global.invalidGlobs();
+    for (const auto &set : m_perDevice) {
+        hits += set.hits;
+        misses += set.misses;
+        cached += set.cachedVerdicts();
+        invalid += set.invalidGlobs();
+    }
+
+    QVariantMap out;
+    out.insert(QStringLiteral("rules"), m_ruleCount);
+    out.insert(QStringLiteral("invalidRules"), invalid);
+    out.insert(QStringLiteral("deviceRuleSets"), m_perDevice.size());
+    out.insert(QStringLiteral("cachedVerdicts"), cached);
+    out.insert(QStringLiteral("verdictHits"), hits);
+    out.insert(QStringLiteral("verdictMisses"), misses);
+    return out;
+}
@@ -0,0 +1,103 @@
+#include "Histogram.h"
+
+#include <QVariantList>
+#include <QtAlgorithms>
+
+Histogram::Histogram()
+{
+    reset();
+}
+
+int Histogram::bucketFor(qint64 nanoseconds)
+{
+    const quint64 us = nanoseconds > 0 ? static_cast<quint64>(nanoseconds) / 1000u : 0u;
+    if (us == 0)
+        return 0;
+    const int bits = 64 - qCountLeadingZeroBits(us);
+    return qMin(bits, kBucketCount - 1);
+}
+
+double Histogram::bucketUpperMs(int bucket)
+{
+    return static_cast<double>(quint64(1) << bucket) / 1000.0;
+}
+
+void Histogram::record(qint64 nanoseconds)
+{
+    if (nanoseconds < 0)
+        nanoseconds = 0;
+    m_buckets[bucketFor(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sumNs.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    qint64 prev = m_maxNs.load(std::memory_order_relaxed);
+    while (nanoseconds > prev && !m_maxNs.compare_exchange_weak(prev, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::reset()
+{
+    for (auto &b : m_buckets)
+        b.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sumNs.store(0, std::memory_order_relaxed);
+    m_maxNs.store(0, std::memory_order_relaxed);
+}
+
+double Histogram::meanMs() const
+{
+    const quint64 n = count();
+    if (n == 0)
+        return 0.0;
+    return static_cast<double>(m_sumNs.load(std::memory_order_relaxed)) / static_cast<double>(n) / 1e6;
+}
+
+double Histogram::maxMs() const
+{
+    return static_cast<double>(m_maxNs.load(std::memory_order_relaxed)) / 1e6;
+}
+
+double Histogram::percentileMs(double p) const
+{
+    std::array<quint64, kBucketCount> snap{};
+    quint64 total = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        snap[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += snap[i];
+    }
+    if (total == 0)
+        return 0.0;
+
+    const quint64 rank = qMax<quint64>(1, static_cast<quint64>(qBound(0.0, p, 1.0) * static_cast<double>(total) + 0.5));
+    quint64 seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += snap[i];
+        if (seen >= rank)
+            return qMin(bucketUpperMs(i), maxMs());
+    }
+    return maxMs();
+}
+
+QVariantMap Histogram::toVariantMap() const
+{
+    QVariantMap out;
+    out.insert(QStringLiteral("count"), count());
+    out.insert(QStringLiteral("meanMs"), meanMs());
+    out.insert(QStringLiteral("p50Ms"), percentileMs(0.50));
+    out.insert(QStringLiteral("p90Ms"), percentileMs(0.90));
+    out.insert(QStringLiteral("p99Ms"), percentileMs(0.99));
+    out.insert(QStringLiteral("maxMs"), maxMs());
+
+    QVariantList buckets;
+    for (int i = 0; i < kBucketCount; ++i) {
+        const quint64 n = m_buckets[i].load(std::memory_order_relaxed);
+        if (n == 0)
+            continue;
+        QVariantMap b;
+        b.insert(QStringLiteral("leMs"), bucketUpperMs(i));
+        b.insert(QStringLiteral("count"), n);
+        buckets.append(b);
+    }
+    out.insert(QStringLiteral("buckets"), buckets);
+    return out;
+}
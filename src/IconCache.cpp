@@ -1,8 +1,21 @@
 #include "IconCache.h"
 
+#include "IconTextureFactory.h"
+#include "Metrics.h"
+
+#include <QColor>
+#include <QCoreApplication>
 #include <QFileInfo>
+#include <QStringList>
 #include <QUrl>
 
+#include <algorithm>
+#include <utility>
+
+// Off Windows (the tests) there is no shell to extract from: every icon is the fallback.
+#ifdef Q_OS_WIN
+#include "ComInit.h"
+
 #include <windows.h>
 #include <shellapi.h>
 
@@ -50,10 +63,77 @@ static QImage qimageFromHICON(HICON hIcon, int desiredPx)
 
     return out;
 }
+#endif
 
 IconCache::IconCache()
-    : QQuickImageProvider(QQuickImageProvider::Image)
+    : QQuickImageProvider(QQuickImageProvider::Texture)
+{
+    m_pool.setMaxThreadCount(2);
+    m_pool.setExpiryTimeout(5000);
+
+    // Icons extracted in earlier runs are available before the first snapshot arrives.
+    m_disk.load();
+    pruneStaleDiskEntries();
+
+    // The destructor runs only when the QML engine is torn down; a kill or forced logoff after
+    // a clean quit request still gets this session's icons written.
+    if (QCoreApplication::instance())
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &IconCache::save);
+}
+
+void IconCache::save()
+{
+    QMutexLocker lock(&m_mutex);
+    // The store is replaced on disk, so no record may keep pointing into the old mapping.
+    for (auto &e : m_cache) {
+        if (e.record && m_disk.isMapped(e.record->image))
+            e.record->image = e.record->image.copy();
+    }
+    m_disk.save();
+}
+
+void IconCache::pruneStaleDiskEntries()
 {
+    // Entries of executables updated or uninstalled since they were stored would otherwise
+    // stay in icons.bin forever. Stat them once, behind any icon loads.
+    const auto stored = m_disk.stamps();
+    if (stored.isEmpty())
+        return;
+    m_pool.start([this, stored]() {
+        QStringList stale;
+        for (auto it = stored.cbegin(); it != stored.cend(); ++it) {
+            if (IconDiskCache::stampFor(it.key()) != it.value())
+                stale.append(it.key());
+        }
+        if (stale.isEmpty())
+            return;
+        QMutexLocker lock(&m_mutex);
+        for (const auto &path : std::as_const(stale)) {
+            // A revalidation may have stored a fresh icon meanwhile.
+            IconDiskCache::Stamp current;
+            if (m_disk.lookup(path, nullptr, &current) && current == stored.value(path)) {
+                m_disk.remove(path);
+                ++m_diskPruned;
+            }
+        }
+    }, -1);
+}
+
+IconCache::~IconCache()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+
+    QMutexLocker lock(&m_mutex);
+    m_cache.clear();
+    m_lru.clear();
+    m_recordByHash.clear();
+    m_disk.saveAndClose();
+}
+
+QString IconCache::placeholderKey()
+{
+    return QStringLiteral("~placeholder");
 }
 
 QString IconCache::ensureIconForExePath(const QString &exePath)
@@ -61,51 +141,409 @@ QString IconCache::ensureIconForExePath(const QString &exePath)
     if (exePath.isEmpty())
         return QString();
 
-    QMutexLocker lock(&m_mutex);
-    if (m_cache.contains(exePath))
-        return exePath;
+    IconDiskCache::Stamp stored;
+    {
+        QMutexLocker lock(&m_mutex);
+        if (touchLocked(exePath))
+            return m_keyByPath.value(exePath, exePath);
 
-    lock.unlock();
-    QImage img = loadSmallIconForExePath(exePath);
-    if (img.isNull()) {
-        img = QImage(24, 24, QImage::Format_ARGB32_Premultiplied);
-        img.fill(QColor(80, 80, 80, 255));
+        // Persisted icon: show it now, confirm it is still current in the background.
+        QImage img;
+        if (m_disk.lookup(exePath, &img, &stored)) {
+            ++m_diskHits;
+            insertLocked(exePath, img);
+            lock.unlock();
+            queueRevalidate(exePath, stored);
+            return exePath;
+        }
     }
 
-    lock.relock();
-    m_cache.insert(exePath, img);
-    return exePath;
+    queueLoad(exePath);
+    return placeholderKey();
 }
 
-QImage IconCache::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+void IconCache::prefetch(const QString &exePath)
+{
+    if (exePath.isEmpty())
+        return;
+
+    IconDiskCache::Stamp stored;
+    {
+        QMutexLocker lock(&m_mutex);
+        if (m_cache.contains(exePath))
+            return;
+        ++m_prefetches;
+        QImage img;
+        if (m_disk.lookup(exePath, &img, &stored)) {
+            ++m_diskHits;
+            insertLocked(exePath, img);
+            lock.unlock();
+            queueRevalidate(exePath, stored);
+            return;
+        }
+    }
+    queueLoad(exePath);
+}
+
+void IconCache::queueLoad(const QString &exePath)
+{
+    {
+        QMutexLocker lock(&m_mutex);
+        if (m_cache.contains(exePath) || m_pending.contains(exePath))
+            return;
+        m_pending.insert(exePath);
+    }
+
+    m_pool.start([this, exePath]() {
+        static auto &loads = Metrics::instance().counter(QStringLiteral("icons.loads"));
+        static auto &loadTime = Metrics::instance().histogram(QStringLiteral("icons.load"));
+        const qint64 startNs = Metrics::nowNs();
+        const IconDiskCache::Stamp stamp = IconDiskCache::stampFor(exePath);
+#ifdef Q_OS_WIN
+        // SHGetFileInfo needs COM on the calling thread.
+        ComInit com(COINIT_APARTMENTTHREADED);
+#endif
+        const QImage img = loadSmallIconForExePath(exePath);
+        // Pre-scale for the sizes QML has asked for so far, still off the GUI thread.
+        const QVector<QImage> variants = makeVariants(img, variantSizes());
+        loads.add();
+        loadTime.record(Metrics::nowNs() - startNs);
+        QMetaObject::invokeMethod(this, [this, exePath, img, variants, stamp]() {
+            finishLoad(exePath, img, variants, stamp);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void IconCache::queueRevalidate(const QString &exePath, const IconDiskCache::Stamp &stored)
 {
-    // QML uses encodeURIComponent(exePath) in the image:// URL.
-    // Decode it back to a real filesystem path.
-    const QString key = QUrl::fromPercentEncoding(id.toUtf8());
-    QImage img;
     {
         QMutexLocker lock(&m_mutex);
-        img = m_cache.value(key);
+        if (m_pending.contains(exePath))
+            return;
+        m_pending.insert(exePath);
     }
 
-    if (img.isNull() && !key.isEmpty()) {
-        img = loadSmallIconForExePath(key);
-        if (!img.isNull()) {
-            QMutexLocker lock(&m_mutex);
-            m_cache.insert(key, img);
+    m_pool.start([this, exePath, stored]() {
+        static auto &revalidations = Metrics::instance().counter(QStringLiteral("icons.revalidations"));
+        revalidations.add();
+        const IconDiskCache::Stamp now = IconDiskCache::stampFor(exePath);
+        QImage img;
+        QVector<QImage> variants;
+        if (now.size >= 0 && now != stored) {
+#ifdef Q_OS_WIN
+            ComInit com(COINIT_APARTMENTTHREADED);
+#endif
+            img = loadSmallIconForExePath(exePath);
+            variants = makeVariants(img, variantSizes());
+        }
+        QMetaObject::invokeMethod(this, [this, exePath, img, variants, stored, now]() {
+            if (now == stored) {
+                QMutexLocker lock(&m_mutex);
+                m_pending.remove(exePath);
+                return;
+            }
+            if (now.size < 0) {
+                // Executable is gone: keep showing the icon, but stop persisting it.
+                QMutexLocker lock(&m_mutex);
+                m_pending.remove(exePath);
+                m_disk.remove(exePath);
+                return;
+            }
+            finishLoad(exePath, img, variants, now);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void IconCache::finishLoad(const QString &exePath, const QImage &loaded, const QVector<QImage> &variants,
+                           const IconDiskCache::Stamp &stamp)
+{
+    QString key = exePath;
+    {
+        QMutexLocker lock(&m_mutex);
+        m_pending.remove(exePath);
+        // Replacing an icon QML may already have cached under the plain key: bump the key so
+        // the Image reloads (the suffix is stripped again in requestImage()).
+        if (m_cache.contains(exePath)) {
+            key = exePath + QLatin1Char('?') + QString::number(++m_generation);
+            m_keyByPath.insert(exePath, key);
         }
+        insertLocked(exePath, loaded, variants);
+        // Failed extractions are not persisted so the next run retries them.
+        if (!loaded.isNull())
+            m_disk.put(exePath, stamp, loaded);
     }
+    emit iconReady(exePath, key);
+}
+
+QImage IconCache::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    // QML uses encodeURIComponent(exePath) in the image:// URL.
+    // Decode it back to a real filesystem path ('?' never occurs in one; it marks a reload).
+    const QString key = QUrl::fromPercentEncoding(id.toUtf8()).section(QLatin1Char('?'), 0, 0);
+    // SessionRow sets sourceSize, so this is the device-pixel size for the row's screen.
+    const int px = requestedSize.isValid() ? qMax(requestedSize.width(), requestedSize.height()) : 0;
 
-    if (requestedSize.isValid() && !img.isNull())
-        img = img.scaled(requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    QImage img;
+    bool cached = false;
+    if (key != placeholderKey()) {
+        QMutexLocker lock(&m_mutex);
+        if (Entry *e = touchLocked(key)) {
+            cached = true;
+            if (px > 0) {
+                img = variantLocked(*e, px);
+                evictLocked();
+            } else {
+                img = e->record ? e->record->image : QImage();
+                // Never let the scene graph hold on to pixels that live in the mapped icon file.
+                if (m_disk.isMapped(img))
+                    img = img.copy();
+            }
+        }
+    }
+
+    // Miss: hand out the placeholder and let the pool fill the cache; the row's icon key flips
+    // to the real one via iconReady().
+    if (!cached) {
+        QMutexLocker lock(&m_mutex);
+        ++m_requestMisses;
+    }
+    if (!cached && !key.isEmpty() && key != placeholderKey())
+        queueLoad(key);
+    // The flat placeholder is left for the scene graph to stretch.
+    if (img.isNull())
+        img = fallbackIcon();
 
     if (size)
         *size = img.size();
     return img;
 }
 
-QImage IconCache::loadSmallIconForExePath(const QString &exePath) const
+QQuickTextureFactory *IconCache::requestTexture(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    return new IconTextureFactory(requestImage(id, size, requestedSize));
+}
+
+void IconCache::setByteBudget(qint64 bytes)
+{
+    QMutexLocker lock(&m_mutex);
+    m_byteBudget = qMax<qint64>(0, bytes);
+    evictLocked();
+}
+
+void IconCache::setPinnedExePaths(const QSet<QString> &exePaths)
+{
+    QMutexLocker lock(&m_mutex);
+    m_pinned = exePaths;
+    evictLocked();
+}
+
+quint64 IconCache::requestMisses() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_requestMisses;
+}
+
+QVariantMap IconCache::stats() const
+{
+    QMutexLocker lock(&m_mutex);
+    QVariantMap out;
+    out.insert(QStringLiteral("hits"), m_hits);
+    out.insert(QStringLiteral("misses"), m_misses);
+    out.insert(QStringLiteral("diskHits"), m_diskHits);
+    out.insert(QStringLiteral("diskPruned"), m_diskPruned);
+    out.insert(QStringLiteral("evictions"), m_evictions);
+    out.insert(QStringLiteral("residentBytes"), m_residentBytes);
+    out.insert(QStringLiteral("byteBudget"), m_byteBudget);
+    out.insert(QStringLiteral("entries"), m_cache.size());
+    out.insert(QStringLiteral("pinned"), m_pinned.size());
+    out.insert(QStringLiteral("pending"), m_pending.size());
+    out.insert(QStringLiteral("reloadKeys"), m_keyByPath.size());
+    out.insert(QStringLiteral("prefetches"), m_prefetches);
+    out.insert(QStringLiteral("requestMisses"), m_requestMisses);
+
+    // Dedup: bytes the entries would take with one image each vs. what is actually resident.
+    QSet<const ImageRecord *> unique;
+    qint64 logicalBytes = 0;
+    for (const auto &e : m_cache) {
+        if (!e.record)
+            continue;
+        unique.insert(e.record.get());
+        logicalBytes += e.record->bytes;
+    }
+    out.insert(QStringLiteral("uniqueImages"), unique.size());
+    out.insert(QStringLiteral("dedupHits"), m_dedupHits);
+    out.insert(QStringLiteral("logicalBytes"), logicalBytes);
+    out.insert(QStringLiteral("dedupRatio"), m_residentBytes > 0 ? double(logicalBytes) / double(m_residentBytes) : 1.0);
+    return out;
+}
+
+IconCache::Entry *IconCache::touchLocked(const QString &exePath)
+{
+    auto it = m_cache.find(exePath);
+    if (it == m_cache.end()) {
+        ++m_misses;
+        return nullptr;
+    }
+    ++m_hits;
+    m_lru.splice(m_lru.begin(), m_lru, it->lru);
+    return &it.value();
+}
+
+void IconCache::insertLocked(const QString &exePath, const QImage &img, QVector<QImage> variants)
+{
+    auto it = m_cache.find(exePath);
+    if (it == m_cache.end()) {
+        m_lru.push_front(exePath);
+        Entry e;
+        e.lru = m_lru.begin();
+        it = m_cache.insert(exePath, e);
+    } else {
+        m_lru.splice(m_lru.begin(), m_lru, it->lru);
+        releaseLocked(*it);
+    }
+    if (!img.isNull())
+        it->record = recordForLocked(img, std::move(variants));
+    evictLocked();
+}
+
+static size_t contentHash(const QImage &img)
+{
+    return qHashBits(img.constBits(), size_t(img.sizeInBytes()),
+                     qHashMulti(0, img.width(), img.height(), int(img.format())));
+}
+
+std::shared_ptr<IconCache::ImageRecord> IconCache::recordForLocked(const QImage &img, QVector<QImage> variants)
+{
+    const size_t hash = contentHash(img);
+    const auto indexed = m_recordByHash.value(hash).lock();
+    if (indexed && indexed->image == img) {
+        ++m_dedupHits;
+        return indexed;
+    }
+
+    auto rec = std::make_shared<ImageRecord>();
+    rec->image = img;
+    rec->hash = hash;
+
+    // Sizes requested since the caller scaled (or none, for disk hits) are filled in here.
+    for (int px : std::as_const(m_variantSizes)) {
+        const bool have = std::any_of(variants.cbegin(), variants.cend(), [px](const QImage &v) {
+            return qMax(v.width(), v.height()) == px;
+        });
+        if (!have)
+            variants.append(ownedLocked(scaledVariant(img, px)));
+    }
+    rec->variants = std::move(variants);
+
+    rec->bytes = img.sizeInBytes();
+    for (const auto &v : std::as_const(rec->variants))
+        rec->bytes += v.sizeInBytes();
+    m_residentBytes += rec->bytes;
+
+    // On a (rare) hash collision the live record keeps the slot and this one stays unshared.
+    if (!indexed)
+        m_recordByHash.insert(hash, rec);
+    return rec;
+}
+
+void IconCache::releaseLocked(Entry &e)
+{
+    if (!e.record)
+        return;
+    if (e.record.use_count() == 1) {
+        m_residentBytes -= e.record->bytes;
+        const auto it = m_recordByHash.find(e.record->hash);
+        if (it != m_recordByHash.end() && it->lock() == e.record)
+            m_recordByHash.erase(it);
+    }
+    e.record.reset();
+}
+
+QImage IconCache::variantLocked(Entry &e, int px)
+{
+    if (!e.record)
+        return {};
+    ImageRecord &rec = *e.record;
+    for (const auto &v : std::as_const(rec.variants)) {
+        if (qMax(v.width(), v.height()) == px)
+            return v; // implicitly shared
+    }
+
+    // First request at this size (new DPI): scale once, and pre-scale future inserts too.
+    if (!m_variantSizes.contains(px))
+        m_variantSizes.append(px);
+    const QImage v = ownedLocked(scaledVariant(rec.image, px));
+    rec.variants.append(v);
+    rec.bytes += v.sizeInBytes();
+    m_residentBytes += v.sizeInBytes();
+    return v;
+}
+
+QImage IconCache::ownedLocked(const QImage &img) const
+{
+    // scaled() to the stored size returns the same (possibly mapped) pixels.
+    return m_disk.isMapped(img) ? img.copy() : img;
+}
+
+QVector<int> IconCache::variantSizes() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_variantSizes;
+}
+
+QImage IconCache::scaledVariant(const QImage &src, int px)
+{
+    // Qt's smooth scaler has vectorized paths for premultiplied ARGB32, so normalize first.
+    const QImage argb = src.format() == QImage::Format_ARGB32_Premultiplied
+        ? src
+        : src.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    return argb.scaled(px, px, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+}
+
+QVector<QImage> IconCache::makeVariants(const QImage &src, const QVector<int> &sizes)
+{
+    QVector<QImage> out;
+    if (src.isNull())
+        return out;
+    out.reserve(sizes.size());
+    for (int px : sizes)
+        out.append(scaledVariant(src, px));
+    return out;
+}
+
+void IconCache::evictLocked()
+{
+    // Walk from the cold end; pinned icons stay no matter how far over budget we are. Failed
+    // extractions hold no pixels, so the entry cap is what bounds those.
+    auto it = m_lru.end();
+    while ((m_residentBytes > m_byteBudget || m_cache.size() > kMaxEntries) && it != m_lru.begin()) {
+        --it;
+        if (m_pinned.contains(*it))
+            continue;
+        const auto entryIt = m_cache.find(*it);
+        if (entryIt != m_cache.end()) {
+            releaseLocked(*entryIt);
+            m_cache.erase(entryIt);
+        }
+        m_keyByPath.remove(*it);
+        it = m_lru.erase(it);
+        ++m_evictions;
+    }
+}
+
+QImage IconCache::fallbackIcon()
+{
+    static const QImage img = []() {
+        QImage out(24, 24, QImage::Format_ARGB32_Premultiplied);
+        out.fill(QColor(80, 80, 80, 255));
+        return out;
+    }();
+    return img;
+}
+
+QImage IconCache::loadSmallIconForExePath(const QString &exePath)
 {
+#ifdef Q_OS_WIN
     const QString path = QFileInfo(exePath).exists() ? exePath : QString();
     if (path.isEmpty())
         return {};
@@ -119,6 +557,10 @@ QImage IconCache::loadSmallIconForExePath(const QString &exePath) const
     QImage img = qimageFromHICON(sfi.hIcon, 64);
     DestroyIcon(sfi.hIcon);
     return img;
+#else
+    Q_UNUSED(exePath);
+    return {};
+#endif
 }
 
 
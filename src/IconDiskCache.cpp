@@ -0,0 +1,284 @@
+#include "IconDiskCache.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace {
+
+constexpr char kMagic[4] = { 'E', 'I', 'C', 'N' };
+constexpr quint32 kVersion = 1;
+
+struct FileHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 count;
+    quint32 reserved;
+};
+
+struct FileEntry
+{
+    quint32 pathOffset; // UTF-16, 2-byte aligned
+    quint32 pathChars;
+    qint64 size;
+    qint64 mtimeMs;
+    quint32 pixelOffset; // ARGB32 premultiplied, 4-byte aligned
+    quint16 width;
+    quint16 height;
+};
+
+static_assert(sizeof(FileHeader) == 16, "icons.bin header layout");
+static_assert(sizeof(FileEntry) == 32, "icons.bin entry layout");
+
+} // namespace
+
+IconDiskCache::IconDiskCache() = default;
+
+IconDiskCache::~IconDiskCache()
+{
+    m_entries.clear();
+    unmap();
+}
+
+QString IconDiskCache::filePath()
+{
+    const QString base = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return QDir(base).filePath(QStringLiteral("icons.bin"));
+}
+
+IconDiskCache::Stamp IconDiskCache::stampFor(const QString &exePath)
+{
+    const QFileInfo fi(exePath);
+    if (!fi.exists())
+        return {};
+    return { fi.size(), fi.lastModified().toMSecsSinceEpoch() };
+}
+
+void IconDiskCache::load()
+{
+    if (m_map)
+        return;
+
+    m_file.setFileName(filePath());
+    if (!m_file.exists() || !m_file.open(QIODevice::ReadOnly))
+        return;
+
+    const qint64 len = m_file.size();
+    if (len < qint64(sizeof(FileHeader))) {
+        m_file.close();
+        return;
+    }
+    uchar *base = m_file.map(0, len);
+    if (!base) {
+        m_file.close();
+        return;
+    }
+
+    FileHeader h{};
+    std::memcpy(&h, base, sizeof(h));
+    const qint64 indexEnd = qint64(sizeof(FileHeader)) + qint64(h.count) * qint64(sizeof(FileEntry));
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kVersion || indexEnd > len) {
+        m_file.unmap(base);
+        m_file.close();
+        return;
+    }
+
+    m_entries.reserve(int(h.count));
+    for (quint32 i = 0; i < h.count; ++i) {
+        FileEntry e{};
+        std::memcpy(&e, base + sizeof(FileHeader) + qint64(i) * qint64(sizeof(FileEntry)), sizeof(e));
+
+        const qint64 pixelBytes = qint64(e.width) * qint64(e.height) * 4;
+        const qint64 pathBytes = qint64(e.pathChars) * 2;
+        if (e.width == 0 || e.height == 0 || e.pathChars == 0
+            || (e.pixelOffset % 4) != 0 || (e.pathOffset % 2) != 0
+            || qint64(e.pixelOffset) + pixelBytes > len || qint64(e.pathOffset) + pathBytes > len)
+            continue;
+
+        const QString path(reinterpret_cast<const QChar *>(base + e.pathOffset), int(e.pathChars));
+        Entry entry;
+        entry.stamp = { e.size, e.mtimeMs };
+        // Read-only wrapper over the mapping; no pixel copy.
+        entry.image = QImage(static_cast<const uchar *>(base + e.pixelOffset), e.width, e.height,
+                             qsizetype(e.width) * 4, QImage::Format_ARGB32_Premultiplied);
+        m_entries.insert(path, entry);
+    }
+
+    m_map = base;
+    m_mapSize = len;
+}
+
+bool IconDiskCache::lookup(const QString &exePath, QImage *img, Stamp *stamp) const
+{
+    const auto it = m_entries.constFind(exePath);
+    if (it == m_entries.constEnd())
+        return false;
+    if (img)
+        *img = it->image;
+    if (stamp)
+        *stamp = it->stamp;
+    return true;
+}
+
+void IconDiskCache::put(const QString &exePath, const Stamp &stamp, const QImage &img)
+{
+    if (exePath.isEmpty() || img.isNull() || stamp.size < 0)
+        return;
+    if (img.width() > 0xFFFF || img.height() > 0xFFFF)
+        return;
+    Entry entry;
+    entry.stamp = stamp;
+    entry.image = img.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    m_entries.insert(exePath, entry);
+    m_dirty = true;
+}
+
+void IconDiskCache::remove(const QString &exePath)
+{
+    if (m_entries.remove(exePath) > 0)
+        m_dirty = true;
+}
+
+QHash<QString, IconDiskCache::Stamp> IconDiskCache::stamps() const
+{
+    QHash<QString, Stamp> out;
+    out.reserve(m_entries.size());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it)
+        out.insert(it.key(), it->stamp);
+    return out;
+}
+
+bool IconDiskCache::isMapped(const QImage &img) const
+{
+    if (!m_map || img.isNull())
+        return false;
+    const uchar *p = img.constBits();
+    return p >= m_map && p < m_map + m_mapSize;
+}
+
+QByteArray IconDiskCache::serialize() const
+{
+    const quint32 count = quint32(m_entries.size());
+
+    // Identical icons (helper binaries of one app, several installs) share one pixel block.
+    struct Block {
+        QImage image;
+        qint64 offset = 0; // relative to the start of the pixel area
+    };
+    QHash<size_t, QVector<Block>> blocksByHash;
+    QHash<QString, qint64> pixelOffsetByPath;
+    qint64 pixelBytes = 0;
+    qint64 pathBytes = 0;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        const QImage &img = it->image;
+        const size_t hash = qHashBits(img.constBits(), size_t(img.sizeInBytes()), qHashMulti(0, img.width(), img.height()));
+        auto &blocks = blocksByHash[hash];
+        qint64 offset = -1;
+        for (const auto &b : std::as_const(blocks)) {
+            if (b.image == img) {
+                offset = b.offset;
+                break;
+            }
+        }
+        if (offset < 0) {
+            offset = pixelBytes;
+            blocks.append({ img, offset });
+            pixelBytes += qint64(img.width()) * qint64(img.height()) * 4;
+        }
+        pixelOffsetByPath.insert(it.key(), offset);
+        pathBytes += qint64(it.key().size()) * 2;
+    }
+
+    // Layout: header | index | pixels (4-aligned) | paths (2-aligned).
+    const qint64 indexEnd = qint64(sizeof(FileHeader)) + qint64(count) * qint64(sizeof(FileEntry));
+    const qint64 total = indexEnd + pixelBytes + pathBytes;
+    if (total > std::numeric_limits<quint32>::max())
+        return {};
+
+    QByteArray out(qsizetype(total), Qt::Uninitialized);
+    uchar *base = reinterpret_cast<uchar *>(out.data());
+
+    FileHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.count = count;
+    std::memcpy(base, &h, sizeof(h));
+
+    for (auto bit = blocksByHash.constBegin(); bit != blocksByHash.constEnd(); ++bit) {
+        for (const auto &b : bit.value()) {
+            const qsizetype rowBytes = qsizetype(b.image.width()) * 4;
+            uchar *dst = base + indexEnd + b.offset;
+            for (int y = 0; y < b.image.height(); ++y)
+                std::memcpy(dst + qsizetype(y) * rowBytes, b.image.constScanLine(y), size_t(rowBytes));
+        }
+    }
+
+    quint32 pathOffset = quint32(indexEnd + pixelBytes);
+    quint32 i = 0;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it, ++i) {
+        const QImage &img = it->image;
+        FileEntry e{};
+        e.pathOffset = pathOffset;
+        e.pathChars = quint32(it.key().size());
+        e.size = it->stamp.size;
+        e.mtimeMs = it->stamp.mtimeMs;
+        e.pixelOffset = quint32(indexEnd + pixelOffsetByPath.value(it.key()));
+        e.width = quint16(img.width());
+        e.height = quint16(img.height());
+        std::memcpy(base + sizeof(FileHeader) + qint64(i) * qint64(sizeof(FileEntry)), &e, sizeof(e));
+
+        std::memcpy(base + pathOffset, it.key().constData(), size_t(e.pathChars) * 2);
+        pathOffset += e.pathChars * 2;
+    }
+    return out;
+}
+
+void IconDiskCache::unmap()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+        m_mapSize = 0;
+    }
+    m_file.close();
+}
+
+void IconDiskCache::saveAndClose()
+{
+    save();
+    m_entries.clear();
+    unmap();
+}
+
+void IconDiskCache::save()
+{
+    if (!m_dirty)
+        return;
+    // Serialize while the mapping (backing the loaded entries) is still valid.
+    const QByteArray bytes = serialize();
+    if (bytes.isEmpty())
+        return;
+
+    if (m_map) {
+        for (auto &entry : m_entries) {
+            if (isMapped(entry.image))
+                entry.image = entry.image.copy();
+        }
+        unmap();
+    }
+    m_dirty = false;
+
+    const QString path = filePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly))
+        return;
+    f.write(bytes);
+    f.commit();
+}
@@ -0,0 +1,80 @@
+#include "IconTextureFactory.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QQuickWindow>
+#include <QSGTexture>
+
+namespace {
+
+// Textures are created and destroyed on the render thread, stats are read from the GUI thread.
+struct TextureStats
+{
+    QMutex mutex;
+    QHash<const QSGTexture *, qint64> keyByTexture; // live icon texture -> comparisonKey
+    QHash<qint64, int> refsByKey;
+    int atlasBacked = 0;
+};
+
+TextureStats &textureStats()
+{
+    static TextureStats s;
+    return s;
+}
+
+} // namespace
+
+IconTextureFactory::IconTextureFactory(const QImage &image)
+    : m_image(image.format() == QImage::Format_ARGB32_Premultiplied
+                  ? image
+                  : image.convertToFormat(QImage::Format_ARGB32_Premultiplied))
+{
+}
+
+QSGTexture *IconTextureFactory::createTexture(QQuickWindow *window) const
+{
+    if (!window || m_image.isNull())
+        return nullptr;
+
+    QSGTexture *t = window->createTextureFromImage(m_image, QQuickWindow::TextureCanUseAtlas);
+    if (!t)
+        return nullptr;
+
+    const qint64 key = t->comparisonKey();
+    const bool atlas = t->isAtlasTexture();
+    {
+        auto &s = textureStats();
+        QMutexLocker lock(&s.mutex);
+        s.keyByTexture.insert(t, key);
+        ++s.refsByKey[key];
+        if (atlas)
+            ++s.atlasBacked;
+    }
+
+    QObject::connect(t, &QObject::destroyed, [t, atlas]() {
+        auto &s = textureStats();
+        QMutexLocker lock(&s.mutex);
+        const auto it = s.keyByTexture.find(t);
+        if (it == s.keyByTexture.end())
+            return;
+        const auto refIt = s.refsByKey.find(it.value());
+        if (refIt != s.refsByKey.end() && --refIt.value() <= 0)
+            s.refsByKey.erase(refIt);
+        s.keyByTexture.erase(it);
+        if (atlas)
+            --s.atlasBacked;
+    });
+    return t;
+}
+
+QVariantMap IconTextureFactory::stats()
+{
+    auto &s = textureStats();
+    QMutexLocker lock(&s.mutex);
+    QVariantMap out;
+    out.insert(QStringLiteral("liveIconTextures"), s.keyByTexture.size());
+    out.insert(QStringLiteral("atlasBacked"), s.atlasBacked);
+    out.insert(QStringLiteral("standalone"), s.keyByTexture.size() - s.atlasBacked);
+    out.insert(QStringLiteral("distinctIconTextures"), s.refsByKey.size());
+    return out;
+}
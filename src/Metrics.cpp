@@ -0,0 +1,91 @@
+#include "Metrics.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+
+template <typename T>
+static T &findOrCreate(std::map<QString, std::unique_ptr<T>> &map, const QString &name)
+{
+    auto &slot = map[name];
+    if (!slot)
+        slot = std::make_unique<T>();
+    return *slot;
+}
+
+Metrics &Metrics::instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+Metrics::Counter &Metrics::counter(const QString &name)
+{
+    QMutexLocker lock(&m_lock);
+    return findOrCreate(m_counters, name);
+}
+
+Metrics::Gauge &Metrics::gauge(const QString &name)
+{
+    QMutexLocker lock(&m_lock);
+    return findOrCreate(m_gauges, name);
+}
+
+Histogram &Metrics::histogram(const QString &name)
+{
+    QMutexLocker lock(&m_lock);
+    return findOrCreate(m_histograms, name);
+}
+
+void Metrics::addSource(const QString &name, QObject *owner, std::function<QVariantMap()> fn)
+{
+    QMutexLocker lock(&m_lock);
+    m_sources.erase(std::remove_if(m_sources.begin(), m_sources.end(), [](const Source &s) { return !s.owner; }),
+                    m_sources.end());
+    m_sources.push_back({name, owner, std::move(fn)});
+}
+
+QVariantMap Metrics::snapshot() const
+{
+    QVariantMap counters;
+    QVariantMap gauges;
+    QVariantMap histograms;
+    std::vector<Source> sources;
+    {
+        QMutexLocker lock(&m_lock);
+        for (const auto &[name, c] : m_counters)
+            counters.insert(name, c->value());
+        for (const auto &[name, g] : m_gauges)
+            gauges.insert(name, g->value());
+        for (const auto &[name, h] : m_histograms)
+            histograms.insert(name, h->toVariantMap());
+        sources = m_sources;
+    }
+
+    // Providers run unlocked: they may record metrics of their own.
+    QVariantMap fromSources;
+    for (const auto &s : sources) {
+        if (s.owner && s.fn)
+            fromSources.insert(s.name, s.fn());
+    }
+
+    QVariantMap out;
+    out.insert(QStringLiteral("counters"), counters);
+    out.insert(QStringLiteral("gauges"), gauges);
+    out.insert(QStringLiteral("histograms"), histograms);
+    out.insert(QStringLiteral("sources"), fromSources);
+    return out;
+}
+
+QByteArray Metrics::toJson() const
+{
+    return QJsonDocument(QJsonObject::fromVariantMap(snapshot())).toJson(QJsonDocument::Indented);
+}
+
+void Metrics::resetHistograms()
+{
+    QMutexLocker lock(&m_lock);
+    for (auto &[name, h] : m_histograms)
+        h->reset();
+}
@@ -0,0 +1,38 @@
+#include "SessionHistory.h"
+
+#include <utility>
+
+void SessionHistory::beginPass()
+{
+    m_passLastActive.clear();
+    m_passSeen.clear();
+    m_inPass = true;
+}
+
+void SessionHistory::commitPass()
+{
+    if (!m_inPass)
+        return;
+    m_lastActive = std::exchange(m_passLastActive, {});
+    m_seen = std::exchange(m_passSeen, {});
+    m_inPass = false;
+}
+
+qint64 SessionHistory::noteSession(const QString &deviceId, quint32 pid, const QString &exePath, bool active, qint64 nowMs)
+{
+    const QString key = deviceId + QLatin1Char('|') + QString::number(pid) + QLatin1Char('|') + exePath;
+    const qint64 lastActive = active ? nowMs : m_lastActive.value(key, 0);
+    if (m_inPass && lastActive > 0)
+        m_passLastActive.insert(key, lastActive);
+    return lastActive;
+}
+
+bool SessionHistory::noteExecutable(const QString &exePath)
+{
+    if (m_inPass)
+        m_passSeen.insert(exePath);
+    if (m_seen.contains(exePath))
+        return false;
+    m_seen.insert(exePath);
+    return true;
+}
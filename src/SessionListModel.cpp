@@ -1,9 +1,15 @@
 #include "SessionListModel.h"
 
-#include "AudioSession.h"
+#include "AudioBackend.h"
 
-SessionListModel::SessionListModel(QObject *parent)
+#include <QtGlobal>
+
+#include <utility>
+
+SessionListModel::SessionListModel(AudioBackend *backend, const QString &deviceId, QObject *parent)
     : QAbstractListModel(parent)
+    , m_backend(backend)
+    , m_deviceId(deviceId)
 {
 }
 
@@ -11,25 +17,26 @@ int SessionListModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid())
         return 0;
-    return m_sessions.size();
+    return m_pid.size() - m_gapSize;
 }
 
 QVariant SessionListModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || index.row() < 0 || index.row() >= m_sessions.size())
-        return {};
-    AudioSession *s = m_sessions.at(index.row());
-    if (!s)
+    if (!index.isValid() || !validRow(index.row()))
         return {};
+    // Rows past the gap left by an unfinished removeAllExcept() have not been moved down yet.
+    const int row = index.row() < m_gapStart ? index.row() : index.row() + m_gapSize;
 
     switch (role) {
-    case SessionObjectRole: return QVariant::fromValue(static_cast<QObject *>(s));
-    case PidRole: return s->pid();
-    case ExePathRole: return s->exePath();
-    case DisplayNameRole: return s->displayName();
-    case IconKeyRole: return s->iconKey();
-    case VolumeRole: return s->volume();
-    case MutedRole: return s->muted();
+    case PidRole: return m_pid.at(row);
+    case DeviceIdRole: return m_deviceId;
+    case ExePathRole: return m_exePath.at(row);
+    case DisplayNameRole: return m_displayName.at(row);
+    case IconKeyRole: return m_iconKey.at(row);
+    case VolumeRole: return static_cast<double>(m_volume.at(row));
+    case MutedRole: return bool(m_flags.at(row) & MutedFlag);
+    case ActiveRole: return bool(m_flags.at(row) & ActiveFlag);
+    case PeakRole: return static_cast<double>(m_peak.at(row));
     default: return {};
     }
 }
@@ -37,59 +44,229 @@ QVariant SessionListModel::data(const QModelIndex &index, int role) const
 QHash<int, QByteArray> SessionListModel::roleNames() const
 {
     return {
-        { SessionObjectRole, "sessionObject" },
         { PidRole, "pid" },
+        { DeviceIdRole, "deviceId" },
         { ExePathRole, "exePath" },
         { DisplayNameRole, "displayName" },
         { IconKeyRole, "iconKey" },
         { VolumeRole, "volume" },
-        { MutedRole, "muted" }
+        { MutedRole, "muted" },
+        { ActiveRole, "active" },
+        { PeakRole, "peak" }
     };
 }
 
-AudioSession *SessionListModel::sessionAt(int row) const
+QString SessionListModel::sessionKey(quint32 pid, const QString &exePath)
 {
-    if (row < 0 || row >= m_sessions.size())
-        return nullptr;
-    return m_sessions.at(row);
+    return QString::number(pid) + QLatin1Char('|') + exePath;
 }
 
 int SessionListModel::indexOf(quint32 pid, const QString &exePath) const
 {
-    for (int i = 0; i < m_sessions.size(); ++i) {
-        AudioSession *s = m_sessions.at(i);
-        if (s && s->pid() == pid && s->exePath() == exePath)
-            return i;
+    return m_rowByKey.value(sessionKey(pid, exePath), -1);
+}
+
+bool SessionListModel::upsert(const Fields &f)
+{
+    const QString key = sessionKey(f.pid, f.exePath);
+    const int existing = m_rowByKey.value(key, -1);
+    const float volume = static_cast<float>(qBound(0.0, f.volume, 1.0));
+    const quint8 flags = quint8((f.muted ? MutedFlag : 0) | (f.active ? ActiveFlag : 0));
+
+    if (existing < 0) {
+        const int row = m_pid.size();
+        beginInsertRows(QModelIndex(), row, row);
+        m_pid.append(f.pid);
+        m_exePath.append(f.exePath);
+        m_displayName.append(f.displayName);
+        m_iconKey.append(f.iconKey);
+        m_volume.append(volume);
+        m_peak.append(0.0f);
+        m_flags.append(flags);
+        m_rowByKey.insert(key, row);
+        endInsertRows();
+        return true;
     }
-    return -1;
+
+    const int row = existing;
+    QVector<int> roles;
+    if (m_displayName.at(row) != f.displayName) {
+        m_displayName[row] = f.displayName;
+        roles.append(DisplayNameRole);
+    }
+    if (m_iconKey.at(row) != f.iconKey) {
+        m_iconKey[row] = f.iconKey;
+        roles.append(IconKeyRole);
+    }
+    if (!qFuzzyCompare(m_volume.at(row), volume)) {
+        m_volume[row] = volume;
+        roles.append(VolumeRole);
+    }
+    const quint8 prev = m_flags.at(row);
+    if (prev != flags) {
+        m_flags[row] = flags;
+        if ((prev ^ flags) & MutedFlag)
+            roles.append(MutedRole);
+        if ((prev ^ flags) & ActiveFlag)
+            roles.append(ActiveRole);
+    }
+    emitRowChanged(row, roles);
+    return false;
 }
 
-void SessionListModel::insertSession(int row, AudioSession *session)
+int SessionListModel::removeAllExcept(const QSet<QString> &keepKeys)
 {
-    if (!session)
-        return;
-    row = qBound(0, row, m_sessions.size());
-    beginInsertRows(QModelIndex(), row, row);
-    m_sessions.insert(row, session);
-    endInsertRows();
+    const int n = m_pid.size();
+    QVector<bool> drop(n, false);
+    int removed = 0;
+    for (int row = 0; row < n; ++row) {
+        if (!keepKeys.contains(sessionKey(m_pid.at(row), m_exePath.at(row)))) {
+            drop[row] = true;
+            ++removed;
+        }
+    }
+    if (removed == 0)
+        return 0;
+
+    // One pass moves every kept row down to its final place. Each run of dropped rows is
+    // announced as one range; until the pass is done, the rows not yet moved sit behind a gap
+    // that rowCount() and data() skip, so the model reads right between the signals.
+    int write = 0;
+    for (int read = 0; read < n;) {
+        if (!drop.at(read)) {
+            if (read != write) {
+                m_pid[write] = m_pid.at(read);
+                m_exePath[write] = std::move(m_exePath[read]);
+                m_displayName[write] = std::move(m_displayName[read]);
+                m_iconKey[write] = std::move(m_iconKey[read]);
+                m_volume[write] = m_volume.at(read);
+                m_peak[write] = m_peak.at(read);
+                m_flags[write] = m_flags.at(read);
+            }
+            ++read;
+            m_gapStart = ++write;
+            continue;
+        }
+        int end = read + 1;
+        while (end < n && drop.at(end))
+            ++end;
+        beginRemoveRows(QModelIndex(), write, write + (end - read) - 1);
+        m_gapSize += end - read;
+        endRemoveRows();
+        read = end;
+    }
+
+    m_pid.resize(write);
+    m_exePath.resize(write);
+    m_displayName.resize(write);
+    m_iconKey.resize(write);
+    m_volume.resize(write);
+    m_peak.resize(write);
+    m_flags.resize(write);
+    m_gapStart = 0;
+    m_gapSize = 0;
+    rebuildIndex();
+    return removed;
 }
 
-void SessionListModel::removeSessionAt(int row)
+void SessionListModel::clear()
 {
-    if (row < 0 || row >= m_sessions.size())
+    if (m_pid.isEmpty())
         return;
-    beginRemoveRows(QModelIndex(), row, row);
-    m_sessions.removeAt(row);
+    beginRemoveRows(QModelIndex(), 0, m_pid.size() - 1);
+    m_pid.clear();
+    m_exePath.clear();
+    m_displayName.clear();
+    m_iconKey.clear();
+    m_volume.clear();
+    m_peak.clear();
+    m_flags.clear();
+    m_rowByKey.clear();
     endRemoveRows();
 }
 
-void SessionListModel::clear()
+void SessionListModel::setVolumeAt(int row, double v)
 {
-    if (m_sessions.isEmpty())
+    if (!validRow(row))
         return;
-    beginRemoveRows(QModelIndex(), 0, m_sessions.size() - 1);
-    m_sessions.clear();
-    endRemoveRows();
+    const float f = static_cast<float>(qBound(0.0, v, 1.0));
+    if (qFuzzyCompare(m_volume.at(row), f))
+        return;
+    m_volume[row] = f;
+    emitRowChanged(row, { VolumeRole });
+}
+
+void SessionListModel::setMutedAt(int row, bool m)
+{
+    setFlag(row, MutedFlag, m, MutedRole);
+}
+
+void SessionListModel::setPeakAt(int row, double p)
+{
+    if (!validRow(row))
+        return;
+    const float f = static_cast<float>(qBound(0.0, p, 1.0));
+    if (qFuzzyCompare(m_peak.at(row), f))
+        return;
+    m_peak[row] = f;
+    emitRowChanged(row, { PeakRole });
+}
+
+void SessionListModel::setIconKeyForExePath(const QString &exePath, const QString &iconKey)
+{
+    for (int row = 0; row < m_exePath.size(); ++row) {
+        if (m_exePath.at(row) != exePath || m_iconKey.at(row) == iconKey)
+            continue;
+        m_iconKey[row] = iconKey;
+        emitRowChanged(row, { IconKeyRole });
+    }
+}
+
+void SessionListModel::setVolume(int row, double v)
+{
+    if (!validRow(row) || !m_backend)
+        return;
+    m_backend->setSessionVolume(m_deviceId, m_pid.at(row), m_exePath.at(row), v);
+}
+
+void SessionListModel::setMuted(int row, bool m)
+{
+    if (!validRow(row) || !m_backend)
+        return;
+    m_backend->setSessionMuted(m_deviceId, m_pid.at(row), m_exePath.at(row), m);
 }
 
+void SessionListModel::toggleMute(int row)
+{
+    if (!validRow(row))
+        return;
+    setMuted(row, !mutedAt(row));
+}
+
+void SessionListModel::setFlag(int row, RowFlag flag, bool on, int role)
+{
+    if (!validRow(row))
+        return;
+    const quint8 prev = m_flags.at(row);
+    const quint8 next = on ? quint8(prev | flag) : quint8(prev & ~flag);
+    if (prev == next)
+        return;
+    m_flags[row] = next;
+    emitRowChanged(row, { role });
+}
 
+void SessionListModel::emitRowChanged(int row, const QVector<int> &roles)
+{
+    if (roles.isEmpty())
+        return;
+    const QModelIndex idx = index(row, 0);
+    emit dataChanged(idx, idx, roles);
+}
+
+void SessionListModel::rebuildIndex()
+{
+    m_rowByKey.clear();
+    m_rowByKey.reserve(m_pid.size());
+    for (int row = 0; row < m_pid.size(); ++row)
+        m_rowByKey.insert(sessionKey(m_pid.at(row), m_exePath.at(row)), row);
+}
@@ -0,0 +1,86 @@
+#include "StateCache.h"
+
+#include "AudioState.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+
+constexpr quint32 kMagic = 0x45535443; // "ESTC"
+constexpr quint32 kVersion = 1;
+// Anything beyond this is not a state file we wrote.
+constexpr quint32 kMaxDevices = 256;
+constexpr quint32 kMaxSessionsPerDevice = 1024;
+
+} // namespace
+
+namespace StateCache {
+
+QString filePath()
+{
+    const QString base = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return QDir(base).filePath(QStringLiteral("state.bin"));
+}
+
+QVector<DeviceState> load()
+{
+    QFile f(filePath());
+    if (!f.open(QIODevice::ReadOnly))
+        return {};
+
+    QDataStream in(&f);
+    in.setVersion(QDataStream::Qt_6_5);
+
+    quint32 magic = 0, version = 0, deviceCount = 0;
+    in >> magic >> version >> deviceCount;
+    if (in.status() != QDataStream::Ok || magic != kMagic || version != kVersion || deviceCount > kMaxDevices)
+        return {};
+
+    QVector<DeviceState> out;
+    out.reserve(int(deviceCount));
+    for (quint32 i = 0; i < deviceCount; ++i) {
+        DeviceState ds;
+        quint32 sessionCount = 0;
+        in >> ds.id >> ds.name >> ds.isDefault >> ds.volume >> ds.muted >> sessionCount;
+        if (in.status() != QDataStream::Ok || sessionCount > kMaxSessionsPerDevice)
+            return {};
+        ds.sessions.reserve(int(sessionCount));
+        for (quint32 j = 0; j < sessionCount; ++j) {
+            SessionState ss;
+            ss.deviceId = ds.id;
+            in >> ss.pid >> ss.exePath >> ss.displayName >> ss.volume >> ss.muted >> ss.active;
+            ss.iconKey = ss.exePath;
+            ds.sessions.append(ss);
+        }
+        if (in.status() != QDataStream::Ok)
+            return {};
+        out.append(ds);
+    }
+    return out;
+}
+
+bool save(const QVector<DeviceState> &devices)
+{
+    const QString path = filePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&f);
+    out.setVersion(QDataStream::Qt_6_5);
+    out << kMagic << kVersion << quint32(devices.size());
+    for (const auto &ds : devices) {
+        out << ds.id << ds.name << ds.isDefault << ds.volume << ds.muted << quint32(ds.sessions.size());
+        for (const auto &ss : ds.sessions)
+            out << ss.pid << ss.exePath << ss.displayName << ss.volume << ss.muted << ss.active;
+    }
+    return out.status() == QDataStream::Ok && f.commit();
+}
+
+} // namespace StateCache
@@ -0,0 +1,210 @@
+#include "Tracer.h"
+
+#include "Metrics.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr quint64 kRingCapacity = 1u << 14; // events per thread (512 KiB)
+// Slots at the tail of a wrapped ring that a live export does not trust.
+constexpr quint64 kLiveExportSlack = kRingCapacity / 64;
+// Past this many rings a new thread takes over an exited thread's ring even if that still holds
+// events of the current trace (pool threads come and go for as long as the app runs).
+constexpr size_t kMaxRings = 64;
+
+struct Event
+{
+    qint64 tsNs;
+    quint64 id;
+    const char *name;
+    char phase;
+};
+
+// Single writer (the owning thread); the exporter only reads.
+struct Ring
+{
+    std::array<Event, kRingCapacity> events{};
+    std::atomic<quint64> head{0};
+    quint64 tid = 0;
+    std::atomic<const char *> name{nullptr};
+    // Cleared when the owning thread exits; the ring then only waits to be exported or reused.
+    std::atomic<bool> owned{true};
+
+    bool holdsEventsSince(qint64 startNs) const
+    {
+        const quint64 h = head.load(std::memory_order_acquire);
+        return h > 0 && events[(h - 1) % kRingCapacity].tsNs >= startNs;
+    }
+};
+
+QMutex g_ringsLock;
+std::vector<std::unique_ptr<Ring>> g_rings;
+std::atomic<qint64> g_startNs{0};
+
+// Hands the ring back when its thread exits.
+struct RingLease
+{
+    Ring *ring = nullptr;
+    ~RingLease()
+    {
+        if (ring)
+            ring->owned.store(false, std::memory_order_release);
+    }
+};
+
+thread_local RingLease t_ring;
+thread_local const char *t_threadName = nullptr;
+
+Ring *threadRing()
+{
+    if (t_ring.ring)
+        return t_ring.ring;
+    QMutexLocker lock(&g_ringsLock);
+    // Prefer an exited thread's ring whose events the current trace no longer exports; at the
+    // cap, take the first exited one regardless.
+    const qint64 startNs = g_startNs.load(std::memory_order_relaxed);
+    Ring *reuse = nullptr;
+    for (const auto &ring : g_rings) {
+        if (ring->owned.load(std::memory_order_acquire))
+            continue;
+        if (!ring->holdsEventsSince(startNs)) {
+            reuse = ring.get();
+            break;
+        }
+        if (!reuse && g_rings.size() >= kMaxRings)
+            reuse = ring.get();
+    }
+    if (!reuse) {
+        g_rings.push_back(std::make_unique<Ring>());
+        reuse = g_rings.back().get();
+    }
+    reuse->head.store(0, std::memory_order_relaxed);
+    reuse->tid = quint64(quintptr(QThread::currentThreadId()));
+    reuse->name.store(t_threadName, std::memory_order_relaxed);
+    reuse->owned.store(true, std::memory_order_relaxed);
+    t_ring.ring = reuse;
+    return reuse;
+}
+
+} // namespace
+
+std::atomic<bool> Tracer::s_enabled{false};
+std::atomic<quint64> Tracer::s_nextFlowId{1};
+std::atomic<quint64> Tracer::s_frameFlowId{0};
+
+void Tracer::start()
+{
+    {
+        // Rings of threads that have exited only hold events this start discards.
+        QMutexLocker lock(&g_ringsLock);
+        g_rings.erase(std::remove_if(g_rings.begin(), g_rings.end(),
+                                     [](const std::unique_ptr<Ring> &ring) {
+                                         return !ring->owned.load(std::memory_order_acquire);
+                                     }),
+                      g_rings.end());
+    }
+    g_startNs.store(Metrics::nowNs(), std::memory_order_relaxed);
+    s_frameFlowId.store(0, std::memory_order_relaxed);
+    s_enabled.store(true, std::memory_order_release);
+}
+
+void Tracer::stop()
+{
+    s_enabled.store(false, std::memory_order_release);
+}
+
+void Tracer::setThreadName(const char *name)
+{
+    t_threadName = name;
+    if (t_ring.ring)
+        t_ring.ring->name.store(name, std::memory_order_relaxed);
+}
+
+void Tracer::record(char phase, const char *name, quint64 id)
+{
+    Ring *ring = threadRing();
+    const quint64 i = ring->head.load(std::memory_order_relaxed);
+    ring->events[i % kRingCapacity] = Event{Metrics::nowNs(), id, name, phase};
+    ring->head.store(i + 1, std::memory_order_release);
+}
+
+QByteArray Tracer::exportJson()
+{
+    const qint64 startNs = g_startNs.load(std::memory_order_relaxed);
+    const bool live = enabled();
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray events;
+    QMutexLocker lock(&g_ringsLock);
+    for (const auto &ring : g_rings) {
+        const quint64 head = ring->head.load(std::memory_order_acquire);
+        quint64 first = head > kRingCapacity ? head - kRingCapacity : 0;
+        if (live && head > kRingCapacity)
+            first += kLiveExportSlack;
+
+        const char *threadName = ring->name.load(std::memory_order_relaxed);
+        QJsonObject meta;
+        meta.insert(QStringLiteral("name"), QStringLiteral("thread_name"));
+        meta.insert(QStringLiteral("ph"), QStringLiteral("M"));
+        meta.insert(QStringLiteral("pid"), pid);
+        meta.insert(QStringLiteral("tid"), qint64(ring->tid));
+        meta.insert(QStringLiteral("args"),
+                    QJsonObject{{QStringLiteral("name"),
+                                 threadName ? QString::fromLatin1(threadName) : QStringLiteral("thread %1").arg(ring->tid)}});
+        events.append(meta);
+
+        for (quint64 i = first; i < head; ++i) {
+            const Event &e = ring->events[i % kRingCapacity];
+            if (e.tsNs < startNs)
+                continue;
+            QJsonObject o;
+            o.insert(QStringLiteral("ph"), QString(QLatin1Char(e.phase)));
+            o.insert(QStringLiteral("ts"), double(e.tsNs - startNs) / 1000.0);
+            o.insert(QStringLiteral("pid"), pid);
+            o.insert(QStringLiteral("tid"), qint64(ring->tid));
+            if (e.id) {
+                // Every arrow shares one name/category; the id tells the chains apart.
+                o.insert(QStringLiteral("name"), QStringLiteral("change"));
+                o.insert(QStringLiteral("cat"), QStringLiteral("flow"));
+                o.insert(QStringLiteral("id"), qint64(e.id));
+                if (e.phase != 's')
+                    o.insert(QStringLiteral("bp"), QStringLiteral("e"));
+            } else {
+                o.insert(QStringLiteral("name"), QString::fromLatin1(e.name ? e.name : "?"));
+                o.insert(QStringLiteral("cat"), QStringLiteral("earie"));
+                if (e.phase == 'i')
+                    o.insert(QStringLiteral("s"), QStringLiteral("t"));
+            }
+            events.append(o);
+        }
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("traceEvents"), events);
+    root.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ms"));
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+bool Tracer::saveTo(const QString &path)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+    f.write(exportJson());
+    return f.commit();
+}
@@ -0,0 +1,183 @@
+#include "TrayIconRenderer.h"
+
+#include <QFont>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPixmap>
+#include <QScreen>
+
+#include <algorithm>
+
+// Logical edge length of a notification-area icon (SM_CXSMICON at 96 DPI).
+static constexpr int kTrayLogicalPx = 16;
+static constexpr int kLevelSteps = 10;
+
+static QImage glyph(const QString &path, int px)
+{
+    QImage img = QIcon(path).pixmap(QSize(px, px), 1.0).toImage();
+    if (img.isNull())
+        img = QIcon::fromTheme(QStringLiteral("audio-volume-high")).pixmap(QSize(px, px), 1.0).toImage();
+    if (!img.isNull() && img.size() != QSize(px, px))
+        img = img.scaled(px, px, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    return img.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+
+static QString bucketPath(int level, bool muted)
+{
+    if (muted)
+        return QStringLiteral(":/assets/vol_m.ico");
+    return QStringLiteral(":/assets/vol_%1.ico").arg(level);
+}
+
+TrayIconRenderer::Style TrayIconRenderer::styleFromString(const QString &s)
+{
+    if (s == QLatin1String("levels"))
+        return Style::Levels;
+    if (s == QLatin1String("percent"))
+        return Style::Percent;
+    return Style::Buckets;
+}
+
+QString TrayIconRenderer::styleToString(Style s)
+{
+    switch (s) {
+    case Style::Levels: return QStringLiteral("levels");
+    case Style::Percent: return QStringLiteral("percent");
+    case Style::Buckets: break;
+    }
+    return QStringLiteral("buckets");
+}
+
+void TrayIconRenderer::setStyle(Style s)
+{
+    if (m_style == s)
+        return;
+    m_style = s;
+    m_states.clear();
+}
+
+bool TrayIconRenderer::setTraySizes(QVector<int> sizes)
+{
+    std::sort(sizes.begin(), sizes.end());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+    sizes.removeIf([](int px) { return px <= 0; });
+    if (sizes.isEmpty())
+        sizes.append(kTrayLogicalPx);
+    if (sizes == m_traySizes)
+        return false;
+    m_traySizes = sizes;
+    m_states.clear();
+    return true;
+}
+
+QVector<int> TrayIconRenderer::traySizesForScreens()
+{
+    QVector<int> out;
+    const auto screens = QGuiApplication::screens();
+    for (QScreen *s : screens) {
+        if (s)
+            out.append(qRound(kTrayLogicalPx * s->devicePixelRatio()));
+    }
+    return out;
+}
+
+int TrayIconRenderer::levelCount() const
+{
+    switch (m_style) {
+    case Style::Levels: return kLevelSteps + 1;
+    case Style::Percent: return 101;
+    case Style::Buckets: break;
+    }
+    return 4;
+}
+
+void TrayIconRenderer::prewarm()
+{
+    const int n = levelCount();
+    for (int level = 0; level < n; ++level)
+        stateFor(level, false);
+    // Muted renders the same glyph at every level; one entry serves them all.
+    stateFor(0, true);
+}
+
+int TrayIconRenderer::levelFor(double volume01) const
+{
+    const double v = qBound(0.0, volume01, 1.0);
+    switch (m_style) {
+    case Style::Levels: return qRound(v * kLevelSteps);
+    case Style::Percent: return qRound(v * 100.0);
+    case Style::Buckets: break;
+    }
+    return v < 0.05 ? 0 : (v < 0.33 ? 1 : (v < 0.66 ? 2 : 3));
+}
+
+QIcon TrayIconRenderer::icon(int level, bool muted)
+{
+    return stateFor(level, muted).icon;
+}
+
+size_t TrayIconRenderer::pixelKey(int level, bool muted)
+{
+    return stateFor(level, muted).pixelKey;
+}
+
+const TrayIconRenderer::State &TrayIconRenderer::stateFor(int level, bool muted)
+{
+    level = muted ? 0 : qBound(0, level, levelCount() - 1);
+    const quint32 key = stateKey(level, muted);
+    auto it = m_states.find(key);
+    if (it != m_states.end())
+        return it.value();
+
+    State st;
+    size_t h = 0;
+    for (int px : std::as_const(m_traySizes)) {
+        const QImage img = render(level, muted, px);
+        st.icon.addPixmap(QPixmap::fromImage(img));
+        h = qHashMulti(h, px, qHashBits(img.constBits(), size_t(img.sizeInBytes())));
+    }
+    st.pixelKey = h;
+    return m_states.insert(key, st).value();
+}
+
+QImage TrayIconRenderer::render(int level, bool muted, int px) const
+{
+    if (muted || m_style == Style::Buckets)
+        return glyph(bucketPath(level, muted), px);
+
+    if (m_style == Style::Levels) {
+        QImage img = glyph(bucketPath(0, false), px);
+        QPainter p(&img);
+        p.setRenderHint(QPainter::Antialiasing, true);
+        p.setPen(Qt::NoPen);
+        const int h = qMax(2, px / 8);
+        const QRectF track(0, px - h, px, h);
+        p.setBrush(QColor(0, 0, 0, 110));
+        p.drawRoundedRect(track, h / 2.0, h / 2.0);
+        if (level > 0) {
+            p.setBrush(Qt::white);
+            p.drawRoundedRect(QRectF(track.x(), track.y(), track.width() * level / kLevelSteps, h), h / 2.0, h / 2.0);
+        }
+        return img;
+    }
+
+    // Percent: white digits with a dark outline so they read on light and dark taskbars.
+    QImage img(px, px, QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::transparent);
+    const QString text = QString::number(level);
+    QFont font(QStringLiteral("Segoe UI"));
+    font.setBold(true);
+    font.setPixelSize(qMax(6, qRound(px * (text.size() >= 3 ? 0.56 : 0.78))));
+
+    QPainterPath path;
+    path.addText(0, 0, font, text);
+    const QRectF br = path.boundingRect();
+    path.translate((px - br.width()) / 2.0 - br.x(), (px - br.height()) / 2.0 - br.y());
+
+    QPainter p(&img);
+    p.setRenderHint(QPainter::Antialiasing, true);
+    p.strokePath(path, QPen(QColor(0, 0, 0, 170), qMax(1.0, px / 10.0), Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+    p.fillPath(path, Qt::white);
+    return img;
+}
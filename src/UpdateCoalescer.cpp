@@ -1,5 +1,8 @@
 #include "UpdateCoalescer.h"
 
+#include "Metrics.h"
+#include "Tracer.h"
+
 UpdateCoalescer::UpdateCoalescer(QObject *parent)
     : QObject(parent)
 {
@@ -17,8 +20,16 @@ void UpdateCoalescer::post(std::function<void()> fn)
 
 void UpdateCoalescer::flush()
 {
+    static auto &flushes = Metrics::instance().counter(QStringLiteral("coalescer.flushes"));
+    static auto &tasks = Metrics::instance().counter(QStringLiteral("coalescer.tasks"));
+    static auto &flushTime = Metrics::instance().histogram(QStringLiteral("coalescer.flush"));
+    Metrics::ScopedTimer timer(flushTime);
+    Tracer::Span span("coalescer.flush");
+
     auto work = std::move(m_pending);
     m_pending.clear();
+    flushes.add();
+    tasks.add(work.size());
     for (auto &fn : work) {
         if (fn)
             fn();
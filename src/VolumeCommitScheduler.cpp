@@ -0,0 +1,46 @@
+#include "VolumeCommitScheduler.h"
+
+#include <QtGlobal>
+
+static QString targetKey(const VolumeTarget &t)
+{
+    if (t.kind == VolumeTarget::Kind::Device)
+        return QStringLiteral("d|") + t.deviceId;
+    return QStringLiteral("s|") + t.deviceId + QLatin1Char('|') + QString::number(t.pid) + QLatin1Char('|') + t.exePath;
+}
+
+VolumeCommitScheduler::VolumeCommitScheduler(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(16);
+    connect(&m_timer, &QTimer::timeout, this, &VolumeCommitScheduler::flush);
+}
+
+void VolumeCommitScheduler::schedule(const VolumeTarget &target)
+{
+    VolumeTarget t = target;
+    t.volume = qBound(0.0, t.volume, 1.0);
+
+    const QString key = targetKey(t);
+    auto it = m_indexByKey.constFind(key);
+    if (it != m_indexByKey.constEnd()) {
+        m_pending[it.value()].volume = t.volume;
+    } else {
+        m_indexByKey.insert(key, m_pending.size());
+        m_pending.push_back(t);
+    }
+
+    if (!m_timer.isActive())
+        m_timer.start();
+}
+
+void VolumeCommitScheduler::flush()
+{
+    if (m_pending.isEmpty())
+        return;
+    const QVector<VolumeTarget> batch = std::move(m_pending);
+    m_pending.clear();
+    m_indexByKey.clear();
+    emit batchReady(batch);
+}
@@ -0,0 +1,87 @@
+#include "AllocationHook.h"
+
+#include <cstdlib>
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+#include <crtdbg.h>
+#define EARIE_ALLOCATION_HOOK_CRT
+#elif defined(__GLIBC__)
+#define EARIE_ALLOCATION_HOOK_GLIBC
+#endif
+
+namespace {
+
+// Constant-initialized and local to the executable, so touching it from inside the allocator
+// never allocates.
+thread_local quint64 t_allocations = 0;
+
+} // namespace
+
+#if defined(EARIE_ALLOCATION_HOOK_CRT)
+
+static int countingAllocHook(int allocType, void *, size_t, int blockType, long, const unsigned char *, int)
+{
+    // _CRT_BLOCK is the runtime's own bookkeeping.
+    if ((allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC) && blockType != _CRT_BLOCK)
+        ++t_allocations;
+    return TRUE;
+}
+
+static const bool g_hookInstalled = (_CrtSetAllocHook(countingAllocHook), true);
+
+#elif defined(EARIE_ALLOCATION_HOOK_GLIBC)
+
+// The executable's definitions win symbol lookup for every library it loads (Qt included);
+// glibc's own entry points stay reachable under their __libc_ names. operator new and Qt's
+// allocators end up here. Aligned allocations (posix_memalign and friends) are not counted.
+extern "C" {
+
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *p, std::size_t size);
+void __libc_free(void *p);
+
+void *malloc(std::size_t size)
+{
+    ++t_allocations;
+    return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size)
+{
+    ++t_allocations;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *p, std::size_t size)
+{
+    ++t_allocations;
+    return __libc_realloc(p, size);
+}
+
+void free(void *p)
+{
+    __libc_free(p);
+}
+
+} // extern "C"
+
+#endif
+
+namespace AllocationHook {
+
+bool available()
+{
+#if defined(EARIE_ALLOCATION_HOOK_CRT) || defined(EARIE_ALLOCATION_HOOK_GLIBC)
+    return true;
+#else
+    return false;
+#endif
+}
+
+quint64 threadCount()
+{
+    return t_allocations;
+}
+
+} // namespace AllocationHook
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Heap allocations made by the calling thread, counted by hooking the C allocator of the test
+// executable: the exported malloc/calloc/realloc on glibc, a CRT alloc hook with the MSVC debug
+// runtime. That sees Qt's container storage as well as operator new. Elsewhere available() is
+// false and the count never moves.
+namespace AllocationHook {
+
+bool available();
+quint64 threadCount();
+
+} // namespace AllocationHook
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "AudioBackend.h"
+#include "AudioWorker.h"
+#include "HiddenRuleMatcher.h"
+
+#include <memory>
+
+// The tests' way into AudioBackend (a friend of it): scratch backends with no worker or config
+// that are fed snapshots directly.
+class AudioBackendProbe
+{
+public:
+    // Shows every device. Without an icon cache rows use the exe path as icon key.
+    static std::unique_ptr<AudioBackend> makeBackend(bool withIconCache = false)
+    {
+        std::unique_ptr<AudioBackend> backend(new AudioBackend(nullptr, withIconCache));
+        backend->setAllDevices(true);
+        return backend;
+    }
+
+    static void applySnapshot(AudioBackend &backend, const QVector<DeviceState> &devices)
+    {
+        backend.applySnapshot(devices);
+    }
+    static void applyPeaks(AudioBackend &backend, const QVector<SessionPeak> &peaks) { backend.applyPeaks(peaks); }
+    static HiddenRuleMatcher &hiddenRules(AudioBackend &backend) { return backend.m_hiddenRules; }
+    static int deviceObjects(const AudioBackend &backend) { return int(backend.m_deviceById.size()); }
+};
@@ -0,0 +1,41 @@
+#include "AudioWorker.h"
+
+AudioWorker::AudioWorker(QObject *parent)
+    : QObject(parent)
+{
+}
+
+AudioWorker::~AudioWorker() = default;
+
+void AudioWorker::setAppVolumeTable(const AppVolumeTable &)
+{
+}
+
+void AudioWorker::start()
+{
+}
+
+void AudioWorker::stop()
+{
+}
+
+void AudioWorker::setShowSystemSessions(bool)
+{
+}
+
+void AudioWorker::setVolumes(const QVector<VolumeTarget> &)
+{
+}
+
+void AudioWorker::applyScene(const QVector<VolumeTarget> &targets, qint64, bool measurement)
+{
+    emit sceneApplied(int(targets.size()), 0, 0, 0, measurement);
+}
+
+void AudioWorker::setDeviceMuted(const QString &, bool)
+{
+}
+
+void AudioWorker::setSessionMuted(const QString &, quint32, const QString &, bool)
+{
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include "AppVolumeMemory.h"
+#include "AudioState.h"
+#include "VolumeTarget.h"
+
+// Stand-in for include/AudioWorker.h in the test targets (this directory comes first on their
+// include path): the slots and signals AudioBackend connects to, and no endpoints behind them.
+// Tests feed AudioBackend their own snapshots instead.
+class AudioWorker final : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AudioWorker(QObject *parent = nullptr);
+    ~AudioWorker() override;
+
+    void setAppVolumeTable(const AppVolumeTable &table);
+    quint64 appVolumesApplied() const { return 0; }
+
+public slots:
+    void start();
+    void stop();
+
+    void setShowSystemSessions(bool show);
+
+    void setVolumes(const QVector<VolumeTarget> &targets);
+    void applyScene(const QVector<VolumeTarget> &targets, qint64 requestedAtNs, bool measurement);
+    void setDeviceMuted(const QString &deviceId, bool muted);
+    void setSessionMuted(const QString &deviceId, quint32 pid, const QString &exePath, bool muted);
+
+signals:
+    void snapshotReady(const QVector<DeviceState> &devices, quint64 traceFlow, const QVector<qint64> &changeStampsNs);
+    void peaksReady(const QVector<SessionPeak> &peaks);
+    void executableSeen(const QString &exePath);
+    void sceneApplied(int targets, int written, qint64 queuedNs, qint64 writeNs, bool measurement);
+    void error(const QString &message);
+};
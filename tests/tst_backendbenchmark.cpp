@@ -0,0 +1,314 @@
+#include "AllocationHook.h"
+#include "AudioBackendProbe.h"
+
+#include <QSet>
+#include <QStandardPaths>
+#include <QtTest>
+
+#include <memory>
+
+namespace {
+
+// Distinct executables sessions are drawn from; real machines see a bounded set too.
+constexpr int kExePool = 4096;
+// Inputs prepared per case before timing starts; iterations cycle through them.
+constexpr int kPreparedSteps = 64;
+// Operations each allocation count is averaged over (after one untimed pass).
+constexpr int kAllocationIterations = 256;
+
+QString benchDeviceId(int device)
+{
+    return QStringLiteral("{0.0.0.00000000}.{bench-%1}").arg(device);
+}
+
+QString benchExePath(int n)
+{
+    return QStringLiteral("C:\\Program Files\\Bench%1\\app%2.exe").arg(n % 64).arg(n % kExePool);
+}
+
+// Rule mix of a typical config: exact paths, basenames, directories and globs, none of which
+// match the synthetic sessions (so every row stays visible and the cost is the lookup).
+QSet<QString> benchHiddenRules(int count)
+{
+    QSet<QString> rules;
+    for (int i = 0; i < count; ++i) {
+        switch (i % 4) {
+        case 0: rules.insert(QStringLiteral("C:\\Hidden\\tool%1.exe").arg(i)); break;
+        case 1: rules.insert(QStringLiteral("hidden%1.exe").arg(i)); break;
+        case 2: rules.insert(QStringLiteral("C:\\HiddenDir%1\\").arg(i)); break;
+        default: rules.insert(QStringLiteral("C:\\Glob%1\\*\\*.exe").arg(i)); break;
+        }
+    }
+    return rules;
+}
+
+// Synthetic endpoint/session state. churn() replaces a share of the sessions with new
+// processes (fresh pid, executable from the pool), the way launchers and helpers come and go.
+class SnapshotGenerator
+{
+public:
+    SnapshotGenerator(int devices, int sessionsPerDevice, int churnPercent)
+        : m_churnPercent(churnPercent)
+    {
+        m_devices.reserve(devices);
+        for (int d = 0; d < devices; ++d) {
+            DeviceState ds;
+            ds.id = benchDeviceId(d);
+            ds.name = QStringLiteral("Bench device %1").arg(d);
+            ds.isDefault = d == 0;
+            ds.volume = 0.5;
+            ds.sessions.reserve(sessionsPerDevice);
+            for (int s = 0; s < sessionsPerDevice; ++s)
+                ds.sessions.append(makeSession(ds.id));
+            m_devices.append(ds);
+        }
+    }
+
+    const QVector<DeviceState> &devices() const { return m_devices; }
+
+    void churn()
+    {
+        for (auto &ds : m_devices) {
+            const int n = ds.sessions.size();
+            const int replace = m_churnPercent > 0 ? qMax(1, n * m_churnPercent / 100) : 0;
+            for (int i = 0; i < replace && n > 0; ++i) {
+                ds.sessions[m_cursor % n] = makeSession(ds.id);
+                ++m_cursor;
+            }
+        }
+    }
+
+private:
+    SessionState makeSession(const QString &deviceId)
+    {
+        const quint32 pid = m_nextPid;
+        m_nextPid += 4; // Windows pids are multiples of 4
+        SessionState ss;
+        ss.deviceId = deviceId;
+        ss.pid = pid;
+        ss.exePath = benchExePath(int(pid / 4));
+        ss.displayName = QStringLiteral("App %1").arg(pid / 4 % kExePool);
+        ss.iconKey = ss.exePath;
+        ss.volume = double(pid % 101) / 100.0;
+        ss.active = pid % 3 == 0;
+        return ss;
+    }
+
+    QVector<DeviceState> m_devices;
+    int m_churnPercent = 0;
+    quint32 m_nextPid = 1000;
+    int m_cursor = 0;
+};
+
+enum class Op { ApplySnapshot, PopulateAndClear, ApplyPeaks };
+
+struct Shape
+{
+    int devices = 1;
+    int sessionsPerDevice = 8;
+    int churnPercent = 0;
+    int hiddenRules = 0;
+};
+
+// Steady state, model size, churn and rule count each varied against a 4 x 32 baseline.
+const Shape kSnapshotShapes[] = {
+    {1, 8, 0, 0},
+    {4, 32, 0, 0},
+    {8, 128, 0, 0},
+    {4, 32, 10, 0},
+    {4, 32, 50, 0},
+    {4, 32, 10, 64},
+    {4, 32, 10, 1024},
+    {8, 128, 10, 1024},
+};
+const Shape kPopulateShapes[] = {{1, 8, 0, 0}, {4, 32, 0, 0}, {8, 128, 0, 1024}};
+const Shape kPeakShapes[] = {{1, 8, 0, 0}, {4, 32, 0, 0}, {8, 128, 0, 0}};
+
+void addShapeColumns()
+{
+    QTest::addColumn<int>("devices");
+    QTest::addColumn<int>("sessionsPerDevice");
+    QTest::addColumn<int>("churnPercent");
+    QTest::addColumn<int>("hiddenRules");
+}
+
+QTestData &addShapeRow(const char *prefix, const Shape &s)
+{
+    return QTest::addRow("%s%dx%d churn %d%% rules %d", prefix, s.devices, s.sessionsPerDevice, s.churnPercent,
+                         s.hiddenRules);
+}
+
+void addShapeRow(const Shape &s)
+{
+    addShapeRow("", s) << s.devices << s.sessionsPerDevice << s.churnPercent << s.hiddenRules;
+}
+
+Shape fetchShape()
+{
+    QFETCH(int, devices);
+    QFETCH(int, sessionsPerDevice);
+    QFETCH(int, churnPercent);
+    QFETCH(int, hiddenRules);
+    return Shape{devices, sessionsPerDevice, churnPercent, hiddenRules};
+}
+
+// One case's backend and the inputs its iterations cycle through: consecutive snapshots (one
+// churn step apart) and peak batches for the first of them.
+struct Fixture
+{
+    std::unique_ptr<AudioBackend> backend;
+    QVector<QVector<DeviceState>> snapshots;
+    QVector<QVector<SessionPeak>> peaks;
+
+    Fixture(Op op, const Shape &shape)
+        : backend(AudioBackendProbe::makeBackend())
+    {
+        AudioBackendProbe::hiddenRules(*backend).compile(benchHiddenRules(shape.hiddenRules), {});
+        SnapshotGenerator gen(shape.devices, shape.sessionsPerDevice, shape.churnPercent);
+        for (int i = 0; i < kPreparedSteps; ++i) {
+            snapshots.append(gen.devices());
+            gen.churn();
+        }
+        for (int step = 0; step < kPreparedSteps; ++step) {
+            QVector<SessionPeak> batch;
+            int i = 0;
+            for (const auto &ds : snapshots.first()) {
+                for (const auto &ss : ds.sessions)
+                    batch.append(SessionPeak{ds.id, ss.pid, ss.exePath, double((i++ * 37 + step * 11) % 100) / 100.0});
+            }
+            peaks.append(batch);
+        }
+        // Populating from empty is what PopulateAndClear measures; the others start warm.
+        if (op != Op::PopulateAndClear)
+            AudioBackendProbe::applySnapshot(*backend, snapshots.first());
+    }
+
+    void run(Op op, int i)
+    {
+        switch (op) {
+        case Op::ApplySnapshot:
+            AudioBackendProbe::applySnapshot(*backend, snapshots.at(i % kPreparedSteps));
+            break;
+        case Op::PopulateAndClear:
+            // Startup / device hot-plug into empty models, then every device going away.
+            AudioBackendProbe::applySnapshot(*backend, snapshots.first());
+            AudioBackendProbe::applySnapshot(*backend, {});
+            break;
+        case Op::ApplyPeaks:
+            AudioBackendProbe::applyPeaks(*backend, peaks.at(i % kPreparedSteps));
+            break;
+        }
+    }
+};
+
+} // namespace
+
+Q_DECLARE_METATYPE(Op)
+
+// Time per operation (QBENCHMARK) and heap allocations per operation (allocations(), reported
+// as events) of the GUI side of the snapshot pipeline, fed synthetic snapshots and peak
+// batches of varying device/session counts, session churn and hidden-rule count.
+class BackendBenchmark : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+
+    void applySnapshot_data();
+    void applySnapshot();
+    void populateAndClear_data();
+    void populateAndClear();
+    void applyPeaks_data();
+    void applyPeaks();
+    void allocations_data();
+    void allocations();
+
+private:
+    static void benchmark(Op op);
+};
+
+void BackendBenchmark::initTestCase()
+{
+    // ~AudioBackend writes the state cache; keep it out of the real AppData.
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void BackendBenchmark::benchmark(Op op)
+{
+    Fixture f(op, fetchShape());
+    int i = 0;
+    QBENCHMARK {
+        f.run(op, ++i);
+    }
+}
+
+void BackendBenchmark::applySnapshot_data()
+{
+    addShapeColumns();
+    for (const auto &shape : kSnapshotShapes)
+        addShapeRow(shape);
+}
+
+void BackendBenchmark::applySnapshot()
+{
+    benchmark(Op::ApplySnapshot);
+}
+
+void BackendBenchmark::populateAndClear_data()
+{
+    addShapeColumns();
+    for (const auto &shape : kPopulateShapes)
+        addShapeRow(shape);
+}
+
+void BackendBenchmark::populateAndClear()
+{
+    benchmark(Op::PopulateAndClear);
+}
+
+void BackendBenchmark::applyPeaks_data()
+{
+    addShapeColumns();
+    for (const auto &shape : kPeakShapes)
+        addShapeRow(shape);
+}
+
+void BackendBenchmark::applyPeaks()
+{
+    benchmark(Op::ApplyPeaks);
+}
+
+void BackendBenchmark::allocations_data()
+{
+    QTest::addColumn<Op>("op");
+    addShapeColumns();
+    const auto add = [](Op op, const char *prefix, const Shape &s) {
+        addShapeRow(prefix, s) << op << s.devices << s.sessionsPerDevice << s.churnPercent << s.hiddenRules;
+    };
+    for (const auto &shape : kSnapshotShapes)
+        add(Op::ApplySnapshot, "applySnapshot ", shape);
+    for (const auto &shape : kPopulateShapes)
+        add(Op::PopulateAndClear, "populateAndClear ", shape);
+    for (const auto &shape : kPeakShapes)
+        add(Op::ApplyPeaks, "applyPeaks ", shape);
+}
+
+void BackendBenchmark::allocations()
+{
+    if (!AllocationHook::available())
+        QSKIP("allocation counting needs glibc or the MSVC debug runtime");
+    QFETCH(Op, op);
+    Fixture f(op, fetchShape());
+    // One untimed pass so lazily built state (hashes, row indexes) is not charged to the case.
+    for (int i = 0; i < kPreparedSteps; ++i)
+        f.run(op, i);
+
+    const quint64 before = AllocationHook::threadCount();
+    for (int i = 0; i < kAllocationIterations; ++i)
+        f.run(op, i);
+    const quint64 allocations = AllocationHook::threadCount() - before;
+    QTest::setBenchmarkResult(qreal(allocations) / kAllocationIterations, QTest::Events);
+}
+
+QTEST_GUILESS_MAIN(BackendBenchmark)
+#include "tst_backendbenchmark.moc"
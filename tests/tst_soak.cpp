@@ -0,0 +1,270 @@
+#include "AudioBackendProbe.h"
+#include "AudioDevice.h"
+#include "DeviceListModel.h"
+#include "IconCache.h"
+#include "SessionHistory.h"
+#include "SessionListModel.h"
+
+#include <QRandomGenerator>
+#include <QSet>
+#include <QStandardPaths>
+#include <QtTest>
+
+#include <memory>
+
+namespace {
+
+constexpr int kSimulatedHours = 24;
+constexpr int kTickSeconds = 1;         // simulated time between snapshots
+constexpr int kSampleEveryMinutes = 5;
+constexpr int kStableExes = 128;        // executables that keep their path
+constexpr quint32 kPidSpace = 4096;     // pids are multiples of 4 below 4 * kPidSpace, so they recycle
+
+// Deterministic (fixed seed) stand-in for a desktop's audio endpoints over a day; plays the
+// worker's part as the snapshot source.
+class ChurnSimulation
+{
+public:
+    ChurnSimulation()
+        : m_rng(0x5eed)
+    {
+        m_devices.append(makeDevice(QStringLiteral("{sim-speakers}"), QStringLiteral("Speakers"), 24));
+        m_devices.append(makeDevice(QStringLiteral("{sim-headset}"), QStringLiteral("USB Headset"), 6));
+        m_devices.append(makeDevice(QString(), QStringLiteral("Virtual Cable"), 3));
+    }
+
+    void tick(int second)
+    {
+        const int minute = second / 60;
+        // Headset unplugged for 3 of every 15 minutes; the virtual device is up 10 of every 30
+        // minutes and gets a new endpoint id each time (as after a driver reinstall).
+        setPresent(m_devices[1], minute % 15 < 12);
+        if (!m_devices[2].present && minute % 30 < 10)
+            m_devices[2].state.id = QStringLiteral("{sim-virtual-%1}").arg(++m_virtualGeneration);
+        setPresent(m_devices[2], minute % 30 < 10);
+
+        const bool headsetDefault = m_devices[1].present && (minute / 20) % 2 == 1;
+        m_devices[0].state.isDefault = !headsetDefault;
+        m_devices[1].state.isDefault = headsetDefault;
+
+        for (auto &d : m_devices) {
+            if (!d.present)
+                continue;
+            auto &sessions = d.state.sessions;
+            for (int i = sessions.size() - 1; i >= 0; --i) {
+                if (m_rng.bounded(600) == 0) { // ~10 min mean lifetime
+                    m_pidsInUse.remove(sessions.at(i).pid);
+                    sessions.removeAt(i);
+                }
+            }
+            if (sessions.size() < d.targetSessions && m_rng.bounded(20) == 0)
+                sessions.append(makeSession(d.state.id));
+            if (!sessions.isEmpty() && m_rng.bounded(30) == 0)
+                sessions[m_rng.bounded(int(sessions.size()))].volume = double(m_rng.bounded(101)) / 100.0;
+            if (!sessions.isEmpty() && m_rng.bounded(90) == 0) {
+                auto &ss = sessions[m_rng.bounded(int(sessions.size()))];
+                ss.active = !ss.active;
+            }
+        }
+    }
+
+    QVector<DeviceState> snapshot() const
+    {
+        QVector<DeviceState> out;
+        for (const auto &d : m_devices) {
+            if (d.present)
+                out.append(d.state);
+        }
+        return out;
+    }
+
+private:
+    struct SimDevice
+    {
+        DeviceState state;
+        bool present = false;
+        int targetSessions = 0;
+    };
+
+    SimDevice makeDevice(const QString &id, const QString &name, int targetSessions)
+    {
+        SimDevice d;
+        d.state.id = id;
+        d.state.name = name;
+        d.targetSessions = targetSessions;
+        return d;
+    }
+
+    void setPresent(SimDevice &d, bool present)
+    {
+        if (d.present == present)
+            return;
+        d.present = present;
+        if (!present) {
+            // Sessions go away with their endpoint.
+            for (const auto &ss : std::as_const(d.state.sessions))
+                m_pidsInUse.remove(ss.pid);
+            d.state.sessions.clear();
+        }
+    }
+
+    SessionState makeSession(const QString &deviceId)
+    {
+        quint32 pid = 0;
+        do {
+            pid = 4 * (1 + m_rng.bounded(kPidSpace));
+        } while (m_pidsInUse.contains(pid));
+        m_pidsInUse.insert(pid);
+
+        SessionState ss;
+        ss.deviceId = deviceId;
+        ss.pid = pid;
+        if (m_rng.bounded(3) == 0) {
+            // Self-updating app: every version lives under a new directory. Common enough that
+            // a day outgrows IconCache::kMaxEntries.
+            ss.exePath = QStringLiteral("C:\\Users\\Public\\AppData\\Local\\Updater\\app-1.0.%1\\Updater.exe").arg(++m_updaterVersion);
+        } else {
+            const int n = int(m_rng.bounded(kStableExes));
+            ss.exePath = QStringLiteral("C:\\Program Files\\App%1\\app%1.exe").arg(n);
+        }
+        ss.displayName = ss.exePath.section(QLatin1Char('\\'), -1);
+        ss.iconKey = ss.exePath;
+        ss.volume = double(m_rng.bounded(101)) / 100.0;
+        ss.active = m_rng.bounded(2) == 0;
+        return ss;
+    }
+
+    QRandomGenerator m_rng;
+    QVector<SimDevice> m_devices;
+    QSet<quint32> m_pidsInUse;
+    int m_virtualGeneration = 0;
+    int m_updaterVersion = 0;
+};
+
+// The worker's side of one snapshot: every session noted in a pass, as emitSnapshotNow() does.
+void notePass(SessionHistory &history, const QVector<DeviceState> &devices, qint64 nowMs, bool complete)
+{
+    history.beginPass();
+    for (const auto &ds : devices) {
+        for (const auto &ss : ds.sessions) {
+            history.noteExecutable(ss.exePath);
+            history.noteSession(ds.id, ss.pid, ss.exePath, ss.active, nowMs);
+        }
+    }
+    if (complete)
+        history.commitPass();
+}
+
+} // namespace
+
+// Accelerated session-churn soak of the snapshot pipeline: a day of simulated activity
+// (processes starting and exiting with recycled PIDs, self-updating apps whose path changes
+// every version, a USB headset that comes and goes, a virtual device that reappears under a
+// new id) as one snapshot per simulated second into a backend with a real IconCache, and into
+// the worker's SessionHistory. Every few simulated minutes the long-lived containers must still
+// match the live state they mirror, and the bounded caches must be within their caps.
+class SoakTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void sessionChurn();
+};
+
+void SoakTest::initTestCase()
+{
+    // The backend and icon cache write state.bin and icons.bin; keep them out of the real AppData.
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void SoakTest::sessionChurn()
+{
+    std::unique_ptr<AudioBackend> backend = AudioBackendProbe::makeBackend(true);
+    // The QML engine owns the icon cache in the app.
+    std::unique_ptr<IconCache> icons(backend->iconCache());
+    QVERIFY(icons);
+    HiddenRuleMatcher &hiddenRules = AudioBackendProbe::hiddenRules(*backend);
+    hiddenRules.compile({QStringLiteral("app7.exe"), QStringLiteral("C:\\Program Files\\App1\\"),
+                         QStringLiteral("C:\\Program Files\\App2?\\*.exe")},
+                        {});
+
+    ChurnSimulation sim;
+    SessionHistory history;
+    QSet<QString> exesSeen;
+    const int totalSeconds = kSimulatedHours * 3600;
+    for (int second = 0; second < totalSeconds; second += kTickSeconds) {
+        sim.tick(second);
+        const QVector<DeviceState> devices = sim.snapshot();
+        AudioBackendProbe::applySnapshot(*backend, devices);
+        for (const auto &ds : devices) {
+            for (const auto &ss : ds.sessions)
+                exesSeen.insert(ss.exePath);
+        }
+
+        // Now and then a pass is cut short (worker shutting down): it must not forget anything.
+        const qint64 nowMs = qint64(second) * 1000;
+        if (second % 97 == 0) {
+            const int lastActive = history.lastActiveEntries();
+            const int seen = history.seenExecutables();
+            notePass(history, devices, nowMs, false);
+            QCOMPARE(history.lastActiveEntries(), lastActive);
+            QVERIFY(history.seenExecutables() >= seen);
+        }
+        notePass(history, devices, nowMs, true);
+
+        if (second % (kSampleEveryMinutes * 60) != 0)
+            continue;
+        const int minute = second / 60;
+
+        // Extractions finish on the icon pool and land through the event loop.
+        QTRY_COMPARE_WITH_TIMEOUT(icons->stats().value(QStringLiteral("pending")).toInt(), 0, 10000);
+
+        int liveSessions = 0;
+        int expectedRows = 0;
+        QSet<QString> liveExes;
+        for (const auto &ds : devices) {
+            for (const auto &ss : ds.sessions) {
+                ++liveSessions;
+                liveExes.insert(ss.exePath);
+                if (!hiddenRules.isHidden(ds.id, ss.exePath))
+                    ++expectedRows;
+            }
+        }
+        int sessionRows = 0;
+        int indexedRows = 0;
+        const auto shown = backend->deviceModel()->devices();
+        for (auto *dev : shown) {
+            sessionRows += dev->sessionsModelTyped()->rowCount();
+            indexedRows += dev->sessionsModelTyped()->indexedRows();
+        }
+        const QString at = QStringLiteral("at minute %1").arg(minute);
+
+        // Containers that mirror live state must match it exactly, every time.
+        QVERIFY2(AudioBackendProbe::deviceObjects(*backend) == devices.size(), qPrintable(at));
+        QVERIFY2(backend->findChildren<AudioDevice *>(QString(), Qt::FindDirectChildrenOnly).size() == devices.size(),
+                 qPrintable(at));
+        QVERIFY2(backend->deviceModel()->rowCount() == devices.size(), qPrintable(at));
+        QVERIFY2(sessionRows == expectedRows, qPrintable(at));
+        QVERIFY2(indexedRows == expectedRows, qPrintable(at));
+        QVERIFY2(history.lastActiveEntries() <= liveSessions, qPrintable(at));
+        QVERIFY2(history.seenExecutables() == liveExes.size(), qPrintable(at));
+
+        // Caches may hold more than is live, but never more than their caps.
+        const QVariantMap ruleStats = hiddenRules.stats();
+        const int verdictLimit =
+            HiddenRuleMatcher::kMaxCachedVerdicts * (1 + ruleStats.value(QStringLiteral("deviceRuleSets")).toInt());
+        QVERIFY2(ruleStats.value(QStringLiteral("cachedVerdicts")).toInt() <= verdictLimit, qPrintable(at));
+        const QVariantMap iconStats = icons->stats();
+        const int iconEntries = iconStats.value(QStringLiteral("entries")).toInt();
+        QVERIFY2(iconEntries <= IconCache::kMaxEntries, qPrintable(at));
+        QVERIFY2(iconEntries <= exesSeen.size(), qPrintable(at));
+        QVERIFY2(iconStats.value(QStringLiteral("reloadKeys")).toInt() <= iconEntries, qPrintable(at));
+    }
+
+    // The day has more executables than the icon cache may keep, so the cap must have evicted.
+    QVERIFY(exesSeen.size() > IconCache::kMaxEntries);
+    QVERIFY(icons->stats().value(QStringLiteral("evictions")).toLongLong() > 0);
+}
+
+QTEST_GUILESS_MAIN(SoakTest)
+#include "tst_soak.moc"